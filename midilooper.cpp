@@ -26,14 +26,25 @@
 #include <new>
 
 // Module headers
-#include "generate.h"
+#include "analysis.h"
+#include "budget.h"
+#include "capture.h"
+#include "cclearn.h"
+#include "cvinput.h"
+#include "edit.h"
+#include "freeze.h"
+#include "launch.h"
+#include "metronome.h"
 #include "midi.h"
 #include "midi_utils.h"
+#include "mute.h"
 #include "params.h"
 #include "playback.h"
 #include "recording.h"
 #include "scales.h"
+#include "scenes.h"
 #include "serial.h"
+#include "settings.h"
 #include "types.h"
 #include "ui.h"
 
@@ -41,20 +52,89 @@
 // SPECIFICATIONS
 // ============================================================================
 
-enum SpecIndex { SPEC_NUM_TRACKS = 0, NUM_SPECS };
+enum SpecIndex { SPEC_NUM_TRACKS = 0, SPEC_HELD_NOTES, SPEC_DELAYED_NOTES, NUM_SPECS };
 
 static const _NT_specification specifications[] = {
-    {.name = "Tracks", .min = MIN_TRACKS, .max = MAX_TRACKS, .def = MAX_TRACKS, .type = kNT_typeGeneric}};
+    {.name = "Tracks", .min = MIN_TRACKS, .max = MAX_TRACKS, .def = MAX_TRACKS, .type = kNT_typeGeneric},
+    {.name = "Rec Voices", .min = 1, .max = MAX_HELD_NOTES, .def = DEF_HELD_NOTES, .type = kNT_typeGeneric},
+    {.name = "Delay Voices", .min = 1, .max = MAX_DELAYED_NOTES, .def = DEF_DELAYED_NOTES, .type = kNT_typeGeneric}};
+
+// ============================================================================
+// SHARED PARAMETER DEFINITIONS
+// ============================================================================
+
+// Parameter definitions are read-only and shared by every instance. Only Rec
+// Track's max depends on the instance (its track count), so static memory holds
+// one table per track count and each instance points at the one it needs.
+static _NT_parameter* sharedParamDefs = NULL;
+
+// First entry of the table for numTracks (tables for MIN_TRACKS..MAX_TRACKS, in order)
+static inline uint32_t paramTableOffset(int numTracks) {
+    int tables = numTracks - MIN_TRACKS;
+    int tracksBefore = (numTracks - 1) * numTracks / 2 - (MIN_TRACKS - 1) * MIN_TRACKS / 2;
+    return (uint32_t)(GLOBAL_PARAMS * tables + PARAMS_PER_TRACK * tracksBefore);
+}
+
+void calculateStaticRequirements(_NT_staticRequirements& req) {
+    req.dram = sizeof(_NT_parameter) * paramTableOffset(MAX_TRACKS + 1);
+}
+
+void initialise(_NT_staticMemoryPtrs& ptrs, const _NT_staticRequirements& req) {
+    sharedParamDefs = (_NT_parameter*)ptrs.dram;
+    for (int n = MIN_TRACKS; n <= MAX_TRACKS; n++) {
+        _NT_parameter* defs = sharedParamDefs + paramTableOffset(n);
+        memcpy(defs, parameters, sizeof(_NT_parameter) * calcTotalParams(n));
+        defs[kParamRecTrack].max = n - 1;
+    }
+    (void)req;
+}
 
 // ============================================================================
 // FACTORY FUNCTIONS
 // ============================================================================
 
+// DRAM layout: TrackState[numTracks], EditClipboard[1 + numTracks] (the clipboard, then each track's queued
+// Paste snapshot), CaptureBuffer (4-byte aligned), FreezeBuffer, SceneBank,
+// CcMap (4-byte aligned), Note Map table uint8_t[128], pattern slots TrackData[numTracks * NUM_PATTERNS] (4-byte aligned),
+// SaveStage (4-byte aligned)
+static inline uint32_t captureBufferOffset(int numTracks) {
+    return (sizeof(TrackState) * numTracks + sizeof(EditClipboard) * (1 + numTracks) + 3) & ~3u;
+}
+static inline uint32_t freezeBufferOffset(int numTracks) {
+    return captureBufferOffset(numTracks) + sizeof(CaptureBuffer);
+}
+static inline uint32_t sceneBankOffset(int numTracks) {
+    return freezeBufferOffset(numTracks) + sizeof(FreezeBuffer);
+}
+static inline uint32_t ccMapOffset(int numTracks) {
+    return (sceneBankOffset(numTracks) + sizeof(SceneBank) + 3) & ~3u;
+}
+static inline uint32_t pitchMapOffset(int numTracks) {
+    return ccMapOffset(numTracks) + sizeof(CcMap);
+}
+static inline uint32_t patternBankOffset(int numTracks) {
+    return (pitchMapOffset(numTracks) + 128 + 3) & ~3u;
+}
+static inline uint32_t saveStageOffset(int numTracks) {
+    return (patternBankOffset(numTracks) + sizeof(TrackData) * NUM_PATTERNS * numTracks + 3) & ~3u;
+}
+
+// SRAM layout: MidiLooperAlgorithm, DelayedNote[Delay Voices] (4-byte aligned), HeldNote[Rec Voices]
+static inline uint32_t delayedNotesOffset() {
+    return (sizeof(MidiLooperAlgorithm) + 3) & ~3u;
+}
+static inline uint32_t heldNotesOffset(int numDelayed) {
+    return delayedNotesOffset() + sizeof(DelayedNote) * numDelayed;
+}
+
 void calculateRequirements(_NT_algorithmRequirements& req, const int32_t* specs) {
     int numTracks = specs ? specs[SPEC_NUM_TRACKS] : MAX_TRACKS;
+    int numHeld = specs ? specs[SPEC_HELD_NOTES] : DEF_HELD_NOTES;
+    int numDelayed = specs ? specs[SPEC_DELAYED_NOTES] : DEF_DELAYED_NOTES;
     req.numParameters = calcTotalParams(numTracks);
-    req.sram = sizeof(MidiLooperAlgorithm);
-    req.dram = sizeof(TrackState) * numTracks; // Full per-track state
+    req.sram = heldNotesOffset(numDelayed) + sizeof(HeldNote) * numHeld;
+    // Per-track state + edit/capture/freeze/scene/CC buffers + pattern slots + save staging
+    req.dram = saveStageOffset(numTracks) + sizeof(SaveStage);
     req.dtc = sizeof(MidiLooper_DTC);
     req.itc = 0;
 }
@@ -64,11 +144,32 @@ _NT_algorithm* construct(const _NT_algorithmMemoryPtrs& ptrs, const _NT_algorith
     MidiLooper_DTC* dtc = (MidiLooper_DTC*)ptrs.dtc;
     TrackState* trackStates = (TrackState*)ptrs.dram;
     int numTracks = specs ? specs[SPEC_NUM_TRACKS] : MAX_TRACKS;
+    int numHeld = specs ? specs[SPEC_HELD_NOTES] : DEF_HELD_NOTES;
+    int numDelayed = specs ? specs[SPEC_DELAYED_NOTES] : DEF_DELAYED_NOTES;
+    DelayedNote* delayedNotes = (DelayedNote*)(ptrs.sram + delayedNotesOffset());
+    HeldNote* heldNotes = (HeldNote*)(ptrs.sram + heldNotesOffset(numDelayed));
+    EditClipboard* clipboard = (EditClipboard*)(ptrs.dram + sizeof(TrackState) * numTracks);
+    clipboard->length = 0;
+    CaptureBuffer* capture = (CaptureBuffer*)(ptrs.dram + captureBufferOffset(numTracks));
+    capture->written = 0;
+    capture->runStart = 0;
+    FreezeBuffer* freeze = (FreezeBuffer*)(ptrs.dram + freezeBufferOffset(numTracks));
+    SceneBank* scenes = (SceneBank*)(ptrs.dram + sceneBankOffset(numTracks));
+    initScenes(scenes);
+    CcMap* ccMap = (CcMap*)(ptrs.dram + ccMapOffset(numTracks));
+    initCcMap(ccMap);
+    uint8_t* pitchMap = ptrs.dram + pitchMapOffset(numTracks);
+    for (int i = 0; i < 128; i++) {
+        pitchMap[i] = (uint8_t)i;
+    }
+    TrackData* patterns = (TrackData*)(ptrs.dram + patternBankOffset(numTracks));
+    SaveStage* stage = (SaveStage*)(ptrs.dram + saveStageOffset(numTracks));
 
     // Initialize DTC (global state only)
     memset(dtc, 0, sizeof(MidiLooper_DTC));
     for (int i = 0; i < 128; i++) {
         dtc->noteMap[i] = (uint8_t)i;
+        dtc->scaleLut[i] = (uint8_t)i;
     }
     dtc->transportState = TRANSPORT_STOPPED;
     dtc->recordState = REC_IDLE;
@@ -81,17 +182,34 @@ _NT_algorithm* construct(const _NT_algorithmMemoryPtrs& ptrs, const _NT_algorith
     dtc->lastClearTrack = 0;
     dtc->lastClearAll = 0;
     dtc->lastGenerate = 0;
+    dtc->lastExecute = 0;
     dtc->stepRecPos = 0;
+    dtc->audibleMask = 0xFF; // Nothing muted or soloed
+    dtc->cvNote = CV_NOTE_NONE;
 
     // Initialize per-track state in DRAM
     for (int t = 0; t < numTracks; t++) {
         TrackState* ts = &trackStates[t];
 
-        // Clear all track data
+        // Clear all pattern slots; slot 1 plays
+        for (int p = 0; p < NUM_PATTERNS; p++) {
+            TrackData* data = patternSlot(patterns, t, p);
+            for (int s = 0; s < MAX_STEPS; s++) {
+                data->steps[s].count = 0;
+            }
+        }
+        ts->data = patternSlot(patterns, t, 0);
+        ts->pattern = 0;
+        ts->launchSlot = LAUNCH_NONE;
+        memset(ts->slotProgram, 0, sizeof(ts->slotProgram));
+        memset(ts->slotBank, 0, sizeof(ts->slotBank));
+        ts->sentProgram = -1;
         for (int s = 0; s < MAX_STEPS; s++) {
-            ts->data.steps[s].count = 0;
             ts->shuffleOrder[s] = (uint8_t)(s + 1);
         }
+        memset(ts->skipMask, 0, sizeof(ts->skipMask));
+        ts->walkLen = 0;
+        ts->stepMapDirty = true;
 
         // Clear playing notes
         for (int n = 0; n < 128; n++) {
@@ -107,12 +225,22 @@ _NT_algorithm* construct(const _NT_algorithmMemoryPtrs& ptrs, const _NT_algorith
         ts->divCounter = 0;
         ts->loopCount = 0;
         ts->step = 0;
+        ts->walkPos = 0;
         ts->lastStep = 1;
+        ts->repeating = false;
+        ts->repeatValid = 1;
         ts->brownianPos = 1;
         ts->shufflePos = 1;
         ts->activeVel = 0;
         ts->octavePlayCount = 0;
+        ts->leader = -1;
+        ts->depTrack = -1;
+        ts->ticked = false;
+        ts->wrapped = false;
         ts->lastEnabled = (t == 0) ? 1 : 0;
+        ts->histDirty = true;
+        memset(ts->eventRank, 0, sizeof(ts->eventRank)); // Unranked events play until the rebuild
+        ts->ranksDirty = true;
 
         // Initialize cache as dirty
         ts->cache.invalidate();
@@ -127,18 +255,25 @@ _NT_algorithm* construct(const _NT_algorithmMemoryPtrs& ptrs, const _NT_algorith
     }
 
     // Construct algorithm in SRAM
-    MidiLooperAlgorithm* pThis = new (ptrs.sram) MidiLooperAlgorithm(dtc, trackStates, numTracks);
+    MidiLooperAlgorithm* pThis =
+        new (ptrs.sram) MidiLooperAlgorithm(dtc, trackStates, clipboard, capture, freeze, scenes, ccMap, pitchMap, patterns,
+                                            stage, numTracks, heldNotes, numHeld, delayedNotes, numDelayed);
 
     // Initialize held notes
-    for (int i = 0; i < 128; i++) {
+    for (int i = 0; i < numHeld; i++) {
         pThis->heldNotes[i].active = false;
     }
 
     // Initialize delayed notes
-    for (int i = 0; i < MAX_DELAYED_NOTES; i++) {
+    for (int i = 0; i < numDelayed; i++) {
         pThis->delayedNotes[i].active = false;
     }
 
+    memset(pThis->editQueues, 0, sizeof(pThis->editQueues));
+    pThis->captureJob.active = false;
+    pThis->freezeJob.active = false;
+    resetSettings(pThis);
+
     // Build dynamic parameter pages based on track count
     // Page 0: Routing
     pThis->pageDefs[0] = {
@@ -155,25 +290,24 @@ _NT_algorithm* construct(const _NT_algorithmMemoryPtrs& ptrs, const _NT_algorith
     // Page 3: Generate
     pThis->pageDefs[3] = {
         .name = "Generate", .numParams = ARRAY_SIZE(pageGenerate), .group = 3, .unused = {0, 0}, .params = pageGenerate};
-    // Track pages (4 to 4+numTracks-1)
+    // Page 4: Edit
+    pThis->pageDefs[4] = {
+        .name = "Edit", .numParams = ARRAY_SIZE(pageEdit), .group = 4, .unused = {0, 0}, .params = pageEdit};
+    // Track pages (5 to 5+numTracks-1)
     for (int t = 0; t < numTracks; t++) {
         buildTrackPageIndices(pThis->pageTrackIndices[t], t);
-        pThis->pageDefs[4 + t] = {.name = trackPageNames[t],
+        pThis->pageDefs[5 + t] = {.name = trackPageNames[t],
                                   .numParams = PARAMS_PER_TRACK,
-                                  .group = 4,
+                                  .group = 5,
                                   .unused = {0, 0},
                                   .params = pThis->pageTrackIndices[t]};
     }
 
-    pThis->dynamicPages.numPages = 4 + numTracks;
+    pThis->dynamicPages.numPages = 5 + numTracks;
     pThis->dynamicPages.pages = pThis->pageDefs;
 
-    // Copy static parameter definitions into mutable array and adjust Rec Track max
-    memcpy(pThis->paramDefs, parameters, sizeof(_NT_parameter) * calcTotalParams(numTracks));
-    pThis->paramDefs[kParamRecTrack].max = numTracks - 1;
-
-    // Set up parameters and pages
-    pThis->parameters = pThis->paramDefs;
+    // Set up parameters (shared table for this track count) and pages
+    pThis->parameters = sharedParamDefs + paramTableOffset(numTracks);
     pThis->parameterPages = &pThis->dynamicPages;
 
     (void)req; // Silence unused parameter warning
@@ -183,6 +317,23 @@ _NT_algorithm* construct(const _NT_algorithmMemoryPtrs& ptrs, const _NT_algorith
 
 void parameterChanged(_NT_algorithm* self, int p) {
     MidiLooperAlgorithm* alg = (MidiLooperAlgorithm*)self;
+    ccParameterTouched(alg, p);
+
+    // Setting selection: show the newly selected setting's value
+    if (p == kParamSetting || p == kParamRecTrack) {
+        alg->dtc->settingSyncPending = true;
+        return;
+    }
+    if (p == kParamSettingValue) {
+        handleSettingValueChanged(alg);
+        return;
+    }
+
+    // Scale change: recompile the quantization table
+    if (p == kParamScaleRoot || p == kParamScaleType) {
+        updateScaleLut(alg);
+        return;
+    }
 
     // Global division change: invalidate all track caches
     if (p == kParamRecDivision) {
@@ -214,6 +365,41 @@ void parameterChanged(_NT_algorithm* self, int p) {
     }
 }
 
+// ============================================================================
+// ACTIONS
+// ============================================================================
+
+// Run the action selected by the Action parameter
+static void executeAction(MidiLooperAlgorithm* alg, int action) {
+    switch (action) {
+    case ACTION_DETECT_KEY:
+    case ACTION_APPLY_KEY:
+        executeKeyDetect(alg, action == ACTION_APPLY_KEY);
+        break;
+    case ACTION_CAPTURE_1:
+        startCapture(alg, 1);
+        break;
+    case ACTION_CAPTURE_2:
+        startCapture(alg, 2);
+        break;
+    case ACTION_CAPTURE_4:
+        startCapture(alg, 4);
+        break;
+    case ACTION_FREEZE:
+        startFreeze(alg);
+        break;
+    case ACTION_SCENE_STORE:
+        storeScene(alg);
+        break;
+    case ACTION_SCENE_RECALL:
+        recallScene(alg);
+        break;
+    default:
+        executeEditAction(alg, action);
+        break;
+    }
+}
+
 // ============================================================================
 // STEP FUNCTION (Audio rate processing)
 // ============================================================================
@@ -223,8 +409,11 @@ void step(_NT_algorithm* self, float* busFrames, int numFramesBy4) {
     MidiLooper_DTC* dtc = alg->dtc;
     const int16_t* v = alg->v;
 
+    dtc->writeSeq++;
+
     int numFrames = numFramesBy4 * 4;
     float dt = (float)numFrames / (float)NT_globals.sampleRate;
+    beginBlockBudget(alg, numFrames);
 
     // Read CV inputs from user-selected buses
     int runBus = v[kParamRunInput];
@@ -255,7 +444,7 @@ void step(_NT_algorithm* self, float* busFrames, int numFramesBy4) {
         if (clearTrack == 1) {
             int track = clampParam(v[kParamRecTrack], 0, alg->numTracks - 1);
             sendTrackNotesOff(alg, track);
-            clearTrackEvents(&alg->trackStates[track].data);
+            clearTrackEvents(&alg->trackStates[track]);
         }
         dtc->lastClearTrack = clearTrack;
     }
@@ -266,7 +455,7 @@ void step(_NT_algorithm* self, float* busFrames, int numFramesBy4) {
         if (clearAll == 1) {
             for (int t = 0; t < alg->numTracks; t++) {
                 sendTrackNotesOff(alg, t);
-                clearTrackEvents(&alg->trackStates[t].data);
+                clearTrackEvents(&alg->trackStates[t]);
             }
         }
         dtc->lastClearAll = clearAll;
@@ -277,17 +466,35 @@ void step(_NT_algorithm* self, float* busFrames, int numFramesBy4) {
     if (generate != dtc->lastGenerate) {
         if (generate == 1) {
             int track = clampParam(v[kParamRecTrack], 0, alg->numTracks - 1);
-            executeGenerate(alg, track);
+            deferGenerate(alg, track);
         }
         dtc->lastGenerate = generate;
     }
 
+    // Parameter change detection: Execute (runs the selected Action)
+    int execute = v[kParamExecute];
+    if (execute != dtc->lastExecute) {
+        if (execute == 1) {
+            executeAction(alg, v[kParamAction]);
+        }
+        dtc->lastExecute = execute;
+    }
+
+    processCcMap(alg, executeAction);
+    syncSettingValue(alg);
+
+    // CV note input, timed within this block before stepTime advances past it
+    processCvInput(alg, busFrames, numFrames);
+
     // Timing and delayed notes
     dtc->stepTime += dt;
+    if (dtc->keyDisplayTime > 0.0f) dtc->keyDisplayTime -= dt;
+    processProgramChanges(alg);
     processDelayedNotes(alg, dt);
 
-    // Recording state machine evaluation
-    {
+    // Recording state machine evaluation. A capture replay owns the held
+    // notes until it finishes, so Record and Rec Track changes wait for it.
+    if (!alg->captureJob.active) {
         int record = v[kParamRecord];
         int recMode = v[kParamRecMode];
         int recTrack = clampParam(v[kParamRecTrack], 0, alg->numTracks - 1);
@@ -308,12 +515,12 @@ void step(_NT_algorithm* self, float* busFrames, int numFramesBy4) {
         case REC_IDLE:
             if (recordChanged && record == 1) {
                 if (isStepMode) {
-                    clearTrackEvents(&alg->trackStates[recTrack].data);
+                    clearTrackEvents(&alg->trackStates[recTrack]);
                     dtc->stepRecPos = 1;
                     dtc->recordState = REC_STEP;
                 } else if (transportIsRunning(dtc->transportState)) {
                     if (recMode == REC_MODE_REPLACE) {
-                        clearTrackEvents(&alg->trackStates[recTrack].data);
+                        clearTrackEvents(&alg->trackStates[recTrack]);
                     }
                     dtc->recordState = REC_LIVE;
                 } else {
@@ -329,7 +536,7 @@ void step(_NT_algorithm* self, float* busFrames, int numFramesBy4) {
             } else if (isStepMode) {
                 // Mode changed to Step while live recording
                 finalizeHeldNotes(alg);
-                clearTrackEvents(&alg->trackStates[recTrack].data);
+                clearTrackEvents(&alg->trackStates[recTrack]);
                 dtc->stepRecPos = 1;
                 dtc->recordState = REC_STEP;
             }
@@ -344,7 +551,7 @@ void step(_NT_algorithm* self, float* busFrames, int numFramesBy4) {
                 dtc->stepRecPos = 0;
                 if (transportIsRunning(dtc->transportState)) {
                     if (recMode == REC_MODE_REPLACE) {
-                        clearTrackEvents(&alg->trackStates[recTrack].data);
+                        clearTrackEvents(&alg->trackStates[recTrack]);
                     }
                     dtc->recordState = REC_LIVE;
                 } else {
@@ -358,23 +565,45 @@ void step(_NT_algorithm* self, float* busFrames, int numFramesBy4) {
                 dtc->recordState = REC_IDLE;
             } else if (isStepMode) {
                 // Mode changed to Step while pending
-                clearTrackEvents(&alg->trackStates[recTrack].data);
+                clearTrackEvents(&alg->trackStates[recTrack]);
                 dtc->stepRecPos = 1;
                 dtc->recordState = REC_STEP;
             } else if (transportIsRunning(dtc->transportState)) {
                 // Normally handled by handleTransportStart(), but kept as
                 // a safety net in case execution order within step() changes.
                 if (recMode == REC_MODE_REPLACE) {
-                    clearTrackEvents(&alg->trackStates[recTrack].data);
+                    clearTrackEvents(&alg->trackStates[recTrack]);
                 }
                 dtc->recordState = REC_LIVE;
             }
             break;
+
+        case REC_COUNT_IN:
+            if (recordChanged && record == 0) {
+                clearHeldNotes(alg);
+                dtc->recordState = REC_IDLE;
+            } else if (isStepMode) {
+                // Mode changed to Step during count-in
+                clearHeldNotes(alg);
+                clearTrackEvents(&alg->trackStates[recTrack]);
+                dtc->stepRecPos = 1;
+                dtc->recordState = REC_STEP;
+            }
+            break;
         }
 
         dtc->lastRecord = record;
     }
 
+    // Scene recall (immediate, or on the clock that starts the next bar/loop)
+    processSceneRecall(alg, clockRising);
+
+    // Mute/solo changes (immediate, or on the clock that starts the next beat/bar/loop)
+    processMuteChange(alg, clockRising);
+
+    // Pattern launches quantized to the bar (wrap launches switch in processTrack)
+    processPatternLaunch(alg, clockRising);
+
     // Clock trigger processing
     if (clockRising && transportIsRunning(dtc->transportState)) {
         // Update step duration estimate
@@ -383,18 +612,48 @@ void step(_NT_algorithm* self, float* busFrames, int numFramesBy4) {
         }
         dtc->stepTime = 0.0f;
 
-        bool panicOnWrap = (v[kParamPanicOnWrap] == 1);
+        // Frame of the rising edge within this block (for click placement)
+        const float* clockFrames = busFrames + (clkBus - 1) * numFrames;
+        int clockOffset = 0;
+        while (clockOffset < numFrames - 1 && clockFrames[clockOffset] <= GATE_THRESHOLD_HIGH) {
+            clockOffset++;
+        }
 
-        // Process each track (gated by per-track clock division)
-        for (int t = 0; t < alg->numTracks; t++) {
-            TrackState* ts = &alg->trackStates[t];
-            int clockDiv = TrackParams::fromAlgorithm(v, t).clockDiv();
-            if (++ts->divCounter >= (uint16_t)clockDiv) {
-                ts->divCounter = 0;
-                processTrack(alg, t, panicOnWrap);
+        // Count-in clocks only drive the metronome; the loop starts on the downbeat
+        if (!advanceCountIn(alg, clockOffset)) {
+            dtc->clockTicks++;
+
+            bool panicOnWrap = (v[kParamPanicOnWrap] == 1);
+            beginTrackClock(alg);
+
+            // Process each track (gated by per-track clock division, followers
+            // by their leader) with leaders and Dep Tracks first
+            for (int i = 0; i < alg->numTracks; i++) {
+                int t = alg->trackOrder[i];
+                TrackState* ts = &alg->trackStates[t];
+                if (ts->leader >= 0) {
+                    ts->ticked = alg->trackStates[ts->leader].ticked;
+                } else {
+                    int clockDiv = TrackParams::fromAlgorithm(v, t).clockDiv();
+                    ts->ticked = (++ts->divCounter >= (uint16_t)clockDiv);
+                    if (ts->ticked) ts->divCounter = 0;
+                }
+                if (ts->ticked) {
+                    processTrack(alg, t, panicOnWrap);
+                }
             }
+
+            metronomeClock(alg, clockOffset);
+            sceneClockProcessed(alg);
+            muteClockProcessed(alg);
+            launchClockProcessed(alg);
         }
     }
+
+    renderMetronome(alg, busFrames, numFrames, dt);
+
+    // Generate, capture, freeze and rank rebuilds with whatever budget is left
+    runDeferredWork(alg);
 }
 
 // ============================================================================
@@ -406,80 +665,31 @@ void midiMessage(_NT_algorithm* self, uint8_t byte0, uint8_t byte1, uint8_t byte
     MidiLooper_DTC* dtc = alg->dtc;
     const int16_t* v = alg->v;
 
+    dtc->writeSeq++;
+
     uint8_t status = byte0 & 0xF0;
     uint8_t channel = byte0 & 0x0F;
 
+    // Learned CCs (matched on their own channel, before the input filter)
+    if (status == kMidiCC && ccMessage(alg, channel, byte1, byte2)) {
+        return;
+    }
+
+    // Pattern launch notes (on their own channel, before the input filter)
+    if (launchNoteMessage(alg, status, channel, byte1, byte2)) {
+        return;
+    }
+
     // Channel filter
     int channelFilter = v[kParamMidiInCh];
     if (channelFilter > 0 && channel != (channelFilter - 1)) {
         return;
     }
 
-    int track = clampParam(v[kParamRecTrack], 0, alg->numTracks - 1);
-    TrackParams tp = TrackParams::fromAlgorithm(v, track);
-    int outCh = tp.channel();
-    uint32_t where = destToWhere(tp.destination());
-
     bool isNoteOn = (status == kMidiNoteOn && byte2 > 0);
     bool isNoteOff = (status == kMidiNoteOff || (status == kMidiNoteOn && byte2 == 0));
-
-    // Scale quantization (applied at input, before pass-through and recording)
-    if (isNoteOn) {
-        uint8_t quantized = quantizeToScale(byte1, v[kParamScaleRoot], v[kParamScaleType]);
-        dtc->noteMap[byte1] = quantized;
-        byte1 = quantized;
-    } else if (isNoteOff) {
-        byte1 = dtc->noteMap[byte1];
-    }
-
-    // Pass-through (if input channel differs from output)
     if (isNoteOn || isNoteOff) {
-        int inCh = channel + 1;
-        if (inCh != outCh) {
-            NT_sendMidi3ByteMessage(where, withChannel(status, outCh), byte1, byte2);
-        }
-    }
-
-    // Update input display state
-    if (isNoteOn) {
-        dtc->inputNotes[byte1] = 1;
-        dtc->inputVel = byte2;
-    } else if (isNoteOff) {
-        dtc->inputNotes[byte1] = 0;
-        // Check if any notes still held
-        bool anyHeld = false;
-        for (int n = 0; n < 128; n++) {
-            if (dtc->inputNotes[n]) {
-                anyHeld = true;
-                break;
-            }
-        }
-        if (!anyHeld) {
-            dtc->inputVel = 0;
-        }
-    }
-
-    // Step recording - process independently of transport
-    if (dtc->recordState == REC_STEP) {
-        if (isNoteOn) {
-            stepRecordNoteOn(alg, track, byte1, byte2);
-        } else if (isNoteOff) {
-            stepRecordNoteOff(alg, track, byte1);
-        }
-        return;
-    }
-
-    // Live recording - only process if in recording state
-    if (dtc->recordState != REC_LIVE) return;
-
-    // Create recording context with current state (uses cached quantize)
-    TrackState* ts = &alg->trackStates[track];
-    RecordingContext ctx = createRecordingContext(v, track, ts->step, dtc->stepTime, dtc->stepDuration, &ts->cache);
-
-    if (isNoteOn) {
-        recordNoteOn(alg, ctx, byte1, byte2);
-    } else if (isNoteOff) {
-        recordNoteOff(alg, ctx, byte1);
+        inputNote(alg, byte1, isNoteOn, byte2, channel + 1, dtc->stepTime);
     }
 }
 
@@ -492,7 +702,12 @@ bool draw(_NT_algorithm* self) { return drawUI((MidiLooperAlgorithm*)self); }
 void serialise(_NT_algorithm* self, _NT_jsonStream& stream) { serialiseData((MidiLooperAlgorithm*)self, stream); }
 
 bool deserialise(_NT_algorithm* self, _NT_jsonParse& parse) {
-    return deserialiseData((MidiLooperAlgorithm*)self, parse);
+    MidiLooperAlgorithm* alg = (MidiLooperAlgorithm*)self;
+    if (!deserialiseData(alg, parse)) return false;
+    alg->dtc->programsPending = true; // Loaded patches follow the preset
+    // Resume: the next start continues from the loaded playback state
+    alg->dtc->resumePending = getSetting(alg, kSetResume) != 0 && !transportIsRunning(alg->dtc->transportState);
+    return true;
 }
 
 // ============================================================================
@@ -500,13 +715,15 @@ bool deserialise(_NT_algorithm* self, _NT_jsonParse& parse) {
 // ============================================================================
 
 static const _NT_factory factory = {
-    .guid = NT_MULTICHAR('M', 'i', 'L', '3'), // MIDI Looper v3
+    // v4: ten global parameters were added ahead of the per-track ones, which
+    // moves every track parameter index, so v3 presets can't load into this
+    .guid = NT_MULTICHAR('M', 'i', 'L', '4'), // MIDI Looper v4
     .name = "MIDI Looper",
     .description = "1-8 track MIDI step recorder/sequencer",
     .numSpecifications = NUM_SPECS,
     .specifications = specifications,
-    .calculateStaticRequirements = NULL,
-    .initialise = NULL,
+    .calculateStaticRequirements = calculateStaticRequirements,
+    .initialise = initialise,
     .calculateRequirements = calculateRequirements,
     .construct = construct,
     .parameterChanged = parameterChanged,
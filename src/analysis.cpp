@@ -0,0 +1,183 @@
+/*
+ * MIDI Looper - Analysis
+ *
+ * Each track keeps a 12-bin pitch-class histogram weighted by velocity x
+ * duration. Recording updates it per event; bulk edits only mark it dirty, so
+ * detection rescans just the tracks that changed and otherwise sums 8 x 12 bins.
+ *
+ * Each event also has an importance rank for the Play Density macro, from its
+ * metric position, velocity and duration. Ranks are rebuilt in the background
+ * after an edit (one track per block, a counting sort over scores), so playback
+ * only compares one byte per event against the macro.
+ */
+
+#include "analysis.h"
+#include "scales.h"
+#include "settings.h"
+
+// ============================================================================
+// HISTOGRAM
+// ============================================================================
+
+static uint32_t eventWeight(uint8_t velocity, uint16_t duration) {
+    uint32_t dur = (duration < KEY_HIST_MAX_DURATION) ? duration : KEY_HIST_MAX_DURATION;
+    return (uint32_t)velocity * dur;
+}
+
+static void histogramAddEvent(TrackState* ts, uint8_t note, uint8_t velocity, uint16_t duration) {
+    if (ts->histDirty) return;  // Rebuilt from scratch before next use
+    ts->pitchHist[note % 12] += eventWeight(velocity, duration);
+}
+
+void analysisAddEvent(TrackState* ts, uint8_t note, uint8_t velocity, uint16_t duration) {
+    histogramAddEvent(ts, note, velocity, duration);
+    ts->ranksDirty = true;  // Ranks are relative to the other events
+}
+
+// Velocity change of one event (newVelocity 0 = removed). Histogram only:
+// callers that fade events mark the ranks dirty themselves, once per pass.
+void analysisFadeEvent(TrackState* ts, uint8_t note, uint8_t oldVelocity, uint8_t newVelocity, uint16_t duration) {
+    if (ts->histDirty) return;
+    uint32_t* bin = &ts->pitchHist[note % 12];
+    uint32_t weight = eventWeight(oldVelocity, duration);
+    *bin = (*bin > weight) ? *bin - weight : 0;
+    *bin += eventWeight(newVelocity, duration);
+}
+
+static void rebuildHistogram(TrackState* ts) {
+    for (int pc = 0; pc < 12; pc++) {
+        ts->pitchHist[pc] = 0;
+    }
+    for (int s = 0; s < MAX_STEPS; s++) {
+        const StepEvents* evs = &ts->data->steps[s];
+        for (int e = 0; e < evs->count; e++) {
+            ts->pitchHist[evs->events[e].note % 12] += eventWeight(evs->events[e].velocity, evs->events[e].duration);
+        }
+    }
+    ts->histDirty = false;
+}
+
+// ============================================================================
+// IMPORTANCE RANKS
+// ============================================================================
+
+// Higher is more important: downbeats, then loud, then long events
+static int importanceScore(int stepIdx, const NoteEvent* ev) {
+    int metric = 0; // Trailing zero bits of the step index (step 1 counts as the strongest)
+    while (metric < RANK_METRIC_LEVELS - 1 && !((stepIdx >> metric) & 1)) metric++;
+    int dur = (ev->duration < RANK_DURATION_CAP) ? ev->duration : RANK_DURATION_CAP;
+    return metric * RANK_METRIC_WEIGHT + ev->velocity / 2 + dur * RANK_DURATION_WEIGHT;
+}
+
+// Rank = percentage of the track's events more important than this one, so
+// Play Density N keeps roughly the top N% and ties are kept or dropped together
+static void rebuildEventRanks(TrackState* ts) {
+    uint16_t above[RANK_SCORE_RANGE + 1] = {};
+    for (int s = 0; s < MAX_STEPS; s++) {
+        const StepEvents* evs = &ts->data->steps[s];
+        for (int e = 0; e < evs->count; e++) {
+            above[importanceScore(s, &evs->events[e])]++;
+        }
+    }
+
+    // Suffix sums: above[score] = events scoring higher than `score`
+    int total = 0;
+    for (int score = RANK_SCORE_RANGE; score >= 0; score--) {
+        int count = above[score];
+        above[score] = (uint16_t)total;
+        total += count;
+    }
+
+    for (int s = 0; s < MAX_STEPS; s++) {
+        const StepEvents* evs = &ts->data->steps[s];
+        for (int e = 0; e < evs->count; e++) {
+            ts->eventRank[s][e] = (uint8_t)(above[importanceScore(s, &evs->events[e])] * 100 / total);
+        }
+    }
+    ts->ranksDirty = false;
+}
+
+void updateEventRanks(MidiLooperAlgorithm* alg) {
+    for (int t = 0; t < alg->numTracks; t++) {
+        TrackState* ts = &alg->trackStates[t];
+        if (ts->ranksDirty) {
+            rebuildEventRanks(ts);
+            return;
+        }
+    }
+}
+
+// ============================================================================
+// KEY DETECTION
+// ============================================================================
+
+// Score one root/scale candidate against the histogram:
+// - in-scale weight counts for, out-of-scale weight against
+// - tonic weight breaks ties between modes that share notes
+// - unused scale degrees cost a little, so a pentatonic melody picks the
+//   pentatonic scale rather than a 7-note superset
+static int32_t scoreKey(const uint32_t* hist, uint32_t total, int root, uint16_t mask) {
+    uint32_t inScale = 0;
+    int emptyDegrees = 0;
+    for (int i = 0; i < 12; i++) {
+        if (!(mask & (1u << i))) continue;
+        uint32_t w = hist[(root + i) % 12];
+        inScale += w;
+        if (w == 0) emptyDegrees++;
+    }
+    return 2 * (int32_t)inScale - (int32_t)total + (int32_t)(hist[root] / 2) -
+           emptyDegrees * (int32_t)(total / 16);
+}
+
+bool detectKey(MidiLooperAlgorithm* alg, int& root, int& scaleType) {
+    uint32_t hist[12] = {};
+    uint32_t total = 0;
+
+    for (int t = 0; t < alg->numTracks; t++) {
+        TrackState* ts = &alg->trackStates[t];
+        if (ts->histDirty) rebuildHistogram(ts);
+        for (int pc = 0; pc < 12; pc++) {
+            hist[pc] += ts->pitchHist[pc];
+        }
+    }
+    for (int pc = 0; pc < 12; pc++) {
+        total += hist[pc];
+    }
+    if (total == 0) return false;
+
+    int32_t bestScore = INT32_MIN;
+    for (int s = 0; s < SCALE_BUILTIN_COUNT - 1; s++) {
+        for (int r = 0; r < 12; r++) {
+            int32_t score = scoreKey(hist, total, r, scaleMasks[s]);
+            if (score > bestScore) {
+                bestScore = score;
+                root = r;
+                scaleType = s + 1;  // Mask table has no OFF entry
+            }
+        }
+    }
+    return true;
+}
+
+// ============================================================================
+// ACTIONS
+// ============================================================================
+
+void executeKeyDetect(MidiLooperAlgorithm* alg, bool apply) {
+    MidiLooper_DTC* dtc = alg->dtc;
+    int root = 0;
+    int scaleType = SCALE_OFF;
+    if (!detectKey(alg, root, scaleType)) {
+        dtc->detectedScale = SCALE_OFF;
+        return;
+    }
+
+    dtc->detectedRoot = (uint8_t)root;
+    dtc->detectedScale = (uint8_t)scaleType;
+    dtc->keyDisplayTime = KEY_DISPLAY_SECONDS;
+
+    if (apply) {
+        setParameterValue(alg, kParamScaleRoot, root);
+        setParameterValue(alg, kParamScaleType, scaleType);
+    }
+}
@@ -0,0 +1,21 @@
+/*
+ * MIDI Looper - Analysis
+ * Key and scale detection and event importance ranks from recorded material
+ */
+
+#pragma once
+
+#include "types.h"
+
+// Derived data maintenance for a single recorded event (bulk edits use markTrackEdited)
+void analysisAddEvent(TrackState* ts, uint8_t note, uint8_t velocity, uint16_t duration);
+void analysisFadeEvent(TrackState* ts, uint8_t note, uint8_t oldVelocity, uint8_t newVelocity, uint16_t duration);
+
+// Rebuild the importance ranks of one edited track (called once per step())
+void updateEventRanks(MidiLooperAlgorithm* alg);
+
+// Best-fitting root and scale over all tracks. Returns false if there are no events.
+bool detectKey(MidiLooperAlgorithm* alg, int& root, int& scaleType);
+
+// Detect Key / Apply Key actions
+void executeKeyDetect(MidiLooperAlgorithm* alg, bool apply);
@@ -0,0 +1,99 @@
+/*
+ * MIDI Looper - Cycle Budget
+ *
+ * Everything that keeps time (clock edges, note-ons, note-offs including
+ * panic and mute cuts, delayed notes, input) runs unconditionally. Work that
+ * can wait a block without being heard is queued and drained at the end of
+ * step(), highest priority first, only while the block is under its cycle
+ * budget. So a clock landing on Generate, a capture commit and a freeze
+ * render doesn't overrun the block: the extra work moves to the next one.
+ *
+ * Each skipped drain is counted per kind of work, and the total is shown on
+ * the display. A kind shed MAX_SHED_BLOCKS
+ * blocks in a row runs regardless, so sustained load slows it down rather
+ * than stopping it.
+ */
+
+#include "budget.h"
+#include "analysis.h"
+#include "capture.h"
+#include "freeze.h"
+#include "generate.h"
+
+void beginBlockBudget(MidiLooperAlgorithm* alg, int numFrames) {
+    MidiLooper_DTC* dtc = alg->dtc;
+    float blockCycles = (float)CPU_CLOCK_HZ * (float)numFrames / (float)NT_globals.sampleRate;
+    dtc->blockBudgetCycles = (uint32_t)(blockCycles * (float)BLOCK_BUDGET_PERCENT / 100.0f);
+    dtc->blockStartCycles = NT_getCpuCycleCount();
+}
+
+bool budgetRemains(const MidiLooperAlgorithm* alg) {
+    const MidiLooper_DTC* dtc = alg->dtc;
+    return NT_getCpuCycleCount() - dtc->blockStartCycles < dtc->blockBudgetCycles;
+}
+
+void deferGenerate(MidiLooperAlgorithm* alg, int track) {
+    alg->dtc->generateMask |= (uint8_t)(1u << track);
+}
+
+static bool ranksPending(const MidiLooperAlgorithm* alg) {
+    for (int t = 0; t < alg->numTracks; t++) {
+        if (alg->trackStates[t].ranksDirty) return true;
+    }
+    return false;
+}
+
+static bool deferredPending(const MidiLooperAlgorithm* alg, int kind) {
+    switch (kind) {
+    case kDeferGenerate:
+        return alg->dtc->generateMask != 0;
+    case kDeferCapture:
+        return alg->captureJob.active;
+    case kDeferFreeze:
+        return alg->freezeJob.active;
+    case kDeferRanks:
+        return ranksPending(alg);
+    default:
+        return false;
+    }
+}
+
+static void runDeferred(MidiLooperAlgorithm* alg, int kind) {
+    switch (kind) {
+    case kDeferGenerate: {
+        // One track per drain; the others stay queued for the next
+        int track = 0;
+        while (!((alg->dtc->generateMask >> track) & 1)) track++;
+        alg->dtc->generateMask &= (uint8_t)~(1u << track);
+        executeGenerate(alg, track);
+        break;
+    }
+    case kDeferCapture:
+        processCapture(alg);
+        break;
+    case kDeferFreeze:
+        processFreeze(alg);
+        break;
+    case kDeferRanks:
+        updateEventRanks(alg);
+        break;
+    }
+}
+
+void runDeferredWork(MidiLooperAlgorithm* alg) {
+    MidiLooper_DTC* dtc = alg->dtc;
+    for (int kind = 0; kind < kDeferCount; kind++) {
+        if (!deferredPending(alg, kind)) {
+            dtc->shedRun[kind] = 0;
+            continue;
+        }
+        if (budgetRemains(alg) || dtc->shedRun[kind] >= MAX_SHED_BLOCKS) {
+            dtc->shedRun[kind] = 0;
+            runDeferred(alg, kind);
+        } else {
+            dtc->shedRun[kind]++;
+            dtc->shedCount[kind]++;
+            DEBUG_LOG("Shed deferred work %d", kind);
+        }
+    }
+}
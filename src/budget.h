@@ -0,0 +1,18 @@
+/*
+ * MIDI Looper - Cycle Budget
+ * Bounds the deferrable work step() does in one block
+ */
+
+#pragma once
+
+#include "types.h"
+
+// Called at the top of step()
+void beginBlockBudget(MidiLooperAlgorithm* alg, int numFrames);
+bool budgetRemains(const MidiLooperAlgorithm* alg);
+
+// Queue a Generate for the next drain (each track keeps its own request)
+void deferGenerate(MidiLooperAlgorithm* alg, int track);
+
+// Called at the end of step(), after clocks and note-offs
+void runDeferredWork(MidiLooperAlgorithm* alg);
@@ -0,0 +1,114 @@
+/*
+ * MIDI Looper - Retrospective Capture
+ *
+ * Every input note on/off is written to a fixed-size ring with the clock it
+ * arrived on and every track's playhead at that moment, whether or not Record
+ * is on. A Capture action replays the
+ * entries inside the last N loops of the Rec Track through recordNoteOn() /
+ * recordNoteOff(), so they snap exactly as a live take would have. The replay
+ * is time-sliced (CAPTURE_EVENTS_PER_BLOCK entries per step() call).
+ */
+
+#include "capture.h"
+#include "midi.h"
+#include "recording.h"
+
+// ============================================================================
+// HISTORY
+// ============================================================================
+
+void captureInputNote(MidiLooperAlgorithm* alg, uint8_t note, uint8_t velocity) {
+    MidiLooper_DTC* dtc = alg->dtc;
+    CaptureBuffer* buf = alg->capture;
+
+    CaptureEvent* ev = &buf->events[buf->written & (CAPTURE_BUFFER_SIZE - 1)];
+    ev->tick = dtc->clockTicks;
+    float frac = (dtc->stepDuration > 0.0f) ? clampf(dtc->stepTime / dtc->stepDuration, 0.0f, 1.0f) : 0.0f;
+    ev->fraction = (uint8_t)(frac * 255.0f);
+    ev->note = note;
+    ev->velocity = velocity;
+    for (int t = 0; t < alg->numTracks; t++) {
+        const TrackState* ts = &alg->trackStates[t];
+        ev->pos[t] = (uint8_t)windowPos(ts, ts->step);
+        ev->divCounter[t] = (uint8_t)ts->divCounter;
+    }
+    buf->written++;
+}
+
+// Forget entries from earlier transport runs (their clock counts no longer line up)
+void resetCaptureHistory(MidiLooperAlgorithm* alg) {
+    alg->capture->runStart = alg->capture->written;
+}
+
+// ============================================================================
+// COMMIT
+// ============================================================================
+
+// Recording context for a note the track's playhead was at `pos` for, `clocks`
+// (plus `fraction`) into that step - the same context a live take would have
+// built (before the first step, notes land on step 1)
+static RecordingContext contextAt(MidiLooperAlgorithm* alg, int track, int pos, int clocks, float fraction) {
+    int clockDiv = TrackParams::fromAlgorithm(alg->v, track).clockDiv();
+    float stepPos = (pos == 0) ? 0.0f : (float)clocks + fraction;
+    return createRecordingContext(alg->v, track, pos, stepPos, (float)clockDiv, &alg->trackStates[track].cache);
+}
+
+void startCapture(MidiLooperAlgorithm* alg, int loops) {
+    MidiLooper_DTC* dtc = alg->dtc;
+    CaptureBuffer* buf = alg->capture;
+    if (alg->captureJob.active || isRecording(dtc->recordState)) return;
+    if (!transportIsRunning(dtc->transportState) || dtc->clockTicks == 0) return;
+
+    int track = clampParam(alg->v[kParamRecTrack], 0, alg->numTracks - 1);
+    TrackParams tp = TrackParams::fromAlgorithm(alg->v, track);
+    uint32_t windowClocks = (uint32_t)(tp.length() * tp.clockDiv() * loops);
+
+    CaptureJob* job = &alg->captureJob;
+    job->track = (uint8_t)track;
+    job->endTick = dtc->clockTicks;
+    const TrackState* ts = &alg->trackStates[track];
+    job->endPos = (uint8_t)windowPos(ts, ts->step);
+    job->endDivCounter = (uint8_t)ts->divCounter;
+    job->startTick = (job->endTick > windowClocks) ? job->endTick - windowClocks + 1 : 0;
+    job->endSeq = buf->written;
+    uint32_t oldest = (buf->written > CAPTURE_BUFFER_SIZE) ? buf->written - CAPTURE_BUFFER_SIZE : 0;
+    job->nextSeq = (oldest > buf->runStart) ? oldest : buf->runStart;
+    job->active = true;
+
+    if (alg->v[kParamRecMode] == REC_MODE_REPLACE) {
+        sendTrackNotesOff(alg, track);
+        clearTrackEvents(&alg->trackStates[track]);
+    }
+    clearHeldNotes(alg);
+}
+
+void processCapture(MidiLooperAlgorithm* alg) {
+    CaptureJob* job = &alg->captureJob;
+    if (!job->active) return;
+    CaptureBuffer* buf = alg->capture;
+
+    for (int i = 0; i < CAPTURE_EVENTS_PER_BLOCK && job->nextSeq < job->endSeq; i++, job->nextSeq++) {
+        // Entry overwritten by newer input since the capture started
+        if (buf->written - job->nextSeq > CAPTURE_BUFFER_SIZE) continue;
+
+        const CaptureEvent& ev = buf->events[job->nextSeq & (CAPTURE_BUFFER_SIZE - 1)];
+        if (ev.tick < job->startTick || ev.tick > job->endTick) continue;
+
+        RecordingContext ctx = contextAt(alg, job->track, ev.pos[job->track], ev.divCounter[job->track], (float)ev.fraction / 255.0f);
+        if (ev.velocity > 0) {
+            recordNoteOn(alg, ctx, ev.note, ev.velocity);
+        } else {
+            recordNoteOff(alg, ctx, ev.note);
+        }
+    }
+    if (job->nextSeq < job->endSeq) return;
+
+    // Notes still held when capture was requested end at that point
+    RecordingContext ctx = contextAt(alg, job->track, job->endPos, job->endDivCounter, 1.0f);
+    for (int i = 0; i < alg->numHeldNotes; i++) {
+        if (alg->heldNotes[i].active) {
+            recordNoteOff(alg, ctx, alg->heldNotes[i].note);
+        }
+    }
+    job->active = false;
+}
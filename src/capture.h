@@ -0,0 +1,16 @@
+/*
+ * MIDI Looper - Retrospective Capture
+ * Always-on input history and commit of the last loops into a track
+ */
+
+#pragma once
+
+#include "types.h"
+
+// History (called for every input note while the transport runs)
+void captureInputNote(MidiLooperAlgorithm* alg, uint8_t note, uint8_t velocity);
+void resetCaptureHistory(MidiLooperAlgorithm* alg);
+
+// Capture 1/2/4 actions and their time-sliced commit
+void startCapture(MidiLooperAlgorithm* alg, int loops);
+void processCapture(MidiLooperAlgorithm* alg);
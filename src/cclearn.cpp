@@ -0,0 +1,143 @@
+/*
+ * MIDI Looper - MIDI CC Learn
+ *
+ * A 16 x 128 slot table turns an incoming (channel, CC) into its mapping with
+ * one lookup. midiMessage() only stores the scaled value (or notes an action
+ * trigger) in the mapping's pending slot, so a burst of CCs costs the same as
+ * one and the latest value wins; step() then writes the pending values through
+ * the normal parameter path and runs triggered actions.
+ *
+ * Learning: set CC Learn to Learn, touch a parameter (or choose an Action),
+ * then move a controller. Setting CC Learn to Forget unmaps the next CC.
+ */
+
+#include "cclearn.h"
+#include <cstring>
+#include "settings.h"
+
+void initCcMap(CcMap* map) {
+    memset(map->slot, 0, sizeof(map->slot));
+    for (int i = 0; i < NUM_CC_MAPPINGS; i++) {
+        map->mappings[i].used = false;
+    }
+    map->pendingMask = 0;
+    map->lastTouched = -1;
+    map->learnPending = false;
+}
+
+// ============================================================================
+// TABLE
+// ============================================================================
+
+bool addCcMapping(CcMap* map, int channel, int cc, int type, int target, int min, int max) {
+    if (channel < 0 || channel > 15 || cc < 0 || cc > 127) return false;
+
+    int index = map->slot[channel][cc] - 1;
+    for (int i = 0; index < 0 && i < NUM_CC_MAPPINGS; i++) {
+        if (!map->mappings[i].used) index = i;
+    }
+    if (index < 0) return false;
+
+    CcMapping* m = &map->mappings[index];
+    m->channel = (uint8_t)channel;
+    m->cc = (uint8_t)cc;
+    m->type = (uint8_t)type;
+    m->lastValue = 0;
+    m->target = (int16_t)target;
+    m->min = (int16_t)min;
+    m->max = (int16_t)max;
+    m->used = true;
+    map->slot[channel][cc] = (uint8_t)(index + 1);
+    map->pendingMask &= ~(1u << index);
+    return true;
+}
+
+static void removeCcMapping(CcMap* map, int channel, int cc) {
+    int index = map->slot[channel][cc] - 1;
+    if (index < 0) return;
+    map->mappings[index].used = false;
+    map->slot[channel][cc] = 0;
+    map->pendingMask &= ~(1u << index);
+}
+
+// ============================================================================
+// LEARN
+// ============================================================================
+
+// Only touches made while learning count, so a parameter moved earlier is
+// never bound by mistake
+void ccParameterTouched(MidiLooperAlgorithm* alg, int param) {
+    if (alg->dtc->settings[kSetCcLearn] != CC_LEARN_BIND) {
+        alg->ccMap->lastTouched = -1;
+        return;
+    }
+    // The Edit page controls are how learning is driven, not learn targets
+    if (param == kParamExecute || param == kParamSetting || param == kParamSettingValue) return;
+    alg->ccMap->lastTouched = (int16_t)param;
+}
+
+// Bind (or forget) the CC that arrived while CC Learn was set, then turn learning off
+static void finishLearn(MidiLooperAlgorithm* alg) {
+    CcMap* map = alg->ccMap;
+    map->learnPending = false;
+
+    int mode = getSetting(alg, kSetCcLearn);
+    if (mode == CC_LEARN_FORGET) {
+        removeCcMapping(map, map->learnChannel, map->learnCc);
+    } else if (mode == CC_LEARN_BIND && map->lastTouched == kParamAction) {
+        addCcMapping(map, map->learnChannel, map->learnCc, CC_TARGET_ACTION, alg->v[kParamAction], 0, 1);
+    } else if (mode == CC_LEARN_BIND && map->lastTouched >= 0) {
+        const _NT_parameter& def = alg->parameters[map->lastTouched];
+        addCcMapping(map, map->learnChannel, map->learnCc, CC_TARGET_PARAM, map->lastTouched, def.min, def.max);
+    }
+
+    map->lastTouched = -1;
+    setSetting(alg, kSetCcLearn, CC_LEARN_OFF);
+    alg->dtc->settingSyncPending = true;
+}
+
+// ============================================================================
+// INPUT AND APPLY
+// ============================================================================
+
+bool ccMessage(MidiLooperAlgorithm* alg, uint8_t channel, uint8_t cc, uint8_t value) {
+    CcMap* map = alg->ccMap;
+    if (alg->dtc->settings[kSetCcLearn] != CC_LEARN_OFF) {
+        map->learnChannel = channel;
+        map->learnCc = cc;
+        map->learnPending = true;
+        return true;
+    }
+
+    int index = map->slot[channel][cc] - 1;
+    if (index < 0) return false;
+
+    CcMapping* m = &map->mappings[index];
+    if (m->type == CC_TARGET_ACTION) {
+        if (value >= CC_ACTION_THRESHOLD && m->lastValue < CC_ACTION_THRESHOLD) {
+            map->pendingMask |= 1u << index;
+        }
+        m->lastValue = value;
+    } else {
+        map->pendingValue[index] = (int16_t)(m->min + (value * (m->max - m->min) + 63) / 127);
+        map->pendingMask |= 1u << index;
+    }
+    return true;
+}
+
+void processCcMap(MidiLooperAlgorithm* alg, CcActionHandler runAction) {
+    CcMap* map = alg->ccMap;
+    if (map->learnPending) finishLearn(alg);
+
+    uint32_t pending = map->pendingMask;
+    map->pendingMask = 0;
+    for (int i = 0; pending != 0; i++, pending >>= 1) {
+        if (!(pending & 1)) continue;
+        const CcMapping* m = &map->mappings[i];
+        if (m->type == CC_TARGET_ACTION) {
+            runAction(alg, m->target);
+        } else if (alg->v[m->target] != map->pendingValue[i]) {
+            setParameterValue(alg, m->target, map->pendingValue[i]);
+        }
+    }
+}
@@ -0,0 +1,24 @@
+/*
+ * MIDI Looper - MIDI CC Learn
+ * (channel, CC) mappings to parameters and actions, saved with the preset
+ */
+
+#pragma once
+
+#include "types.h"
+
+typedef void (*CcActionHandler)(MidiLooperAlgorithm* alg, int action);
+
+void initCcMap(CcMap* map);
+
+// Add or replace the mapping for (channel, cc). Returns false if the table is full.
+bool addCcMapping(CcMap* map, int channel, int cc, int type, int target, int min, int max);
+
+// Called from parameterChanged(): remembers the parameter the next learn binds to
+void ccParameterTouched(MidiLooperAlgorithm* alg, int param);
+
+// Called from midiMessage() for every CC. O(1); returns true if the CC was consumed.
+bool ccMessage(MidiLooperAlgorithm* alg, uint8_t channel, uint8_t cc, uint8_t value);
+
+// Called from step(): finish learning and apply the latest value of each mapped CC
+void processCcMap(MidiLooperAlgorithm* alg, CcActionHandler runAction);
@@ -45,18 +45,93 @@ static constexpr int MAX_EVENTS_PER_STEP = 8; // Maximum polyphony per step
 // PERFORMANCE TUNING
 // ============================================================================
 
+// Note pools, sized per instance by the Rec Voices / Delay Voices specifications
+static constexpr int MAX_HELD_NOTES = 128;   // Notes held at once while recording
+static constexpr int DEF_HELD_NOTES = MAX_HELD_NOTES;
 static constexpr int MAX_DELAYED_NOTES = 64; // Humanization delay buffer size
+static constexpr int DEF_DELAYED_NOTES = MAX_DELAYED_NOTES;
+
+// Retrospective capture: always-on input history and per-block commit budget
+static constexpr int CAPTURE_BUFFER_SIZE = 512;     // Note on/off messages kept (power of two)
+static constexpr int CAPTURE_EVENTS_PER_BLOCK = 16; // History entries committed per step() call
+
+// Freeze: track clocks rendered per step() call
+static constexpr int FREEZE_CLOCKS_PER_BLOCK = 16;
+
+static constexpr int NUM_SCENES = 8; // Scene snapshot slots
+
+// Edits waiting for a track's loop wrap (Edit Quant = Loop), per track
+static constexpr int EDIT_QUEUE_DEPTH = 4;
+
+// Saving: attempts at copying a track between audio calls before settling for
+// the last copy (a copy takes microseconds, an audio block far longer)
+static constexpr int SAVE_STAGE_RETRIES = 8;
+
+// Cycle budget: deferrable work runs only while this instance has used less
+// than BLOCK_BUDGET_PERCENT of a block's CPU cycles; work shed this many
+// blocks in a row runs anyway so it can't be postponed forever
+static constexpr uint32_t CPU_CLOCK_HZ = 600000000;
+static constexpr int BLOCK_BUDGET_PERCENT = 20;
+static constexpr int MAX_SHED_BLOCKS = 64;
+
+static constexpr int NUM_PATTERNS = 4; // Pattern slots per track (launched from MIDI notes)
+
+// Overdub feedback: events fading below this velocity are removed
+static constexpr int FEEDBACK_MIN_VELOCITY = 8;
+
+// Play Density importance score: metric level (trailing zero bits of the step
+// index) outweighs velocity (0-63), which is comparable to duration
+static constexpr int RANK_METRIC_LEVELS = 8;
+static constexpr int RANK_METRIC_WEIGHT = 24;
+static constexpr int RANK_DURATION_CAP = 16;   // Clocks
+static constexpr int RANK_DURATION_WEIGHT = 2;
+static constexpr int RANK_SCORE_RANGE =
+    (RANK_METRIC_LEVELS - 1) * RANK_METRIC_WEIGHT + 63 + RANK_DURATION_CAP * RANK_DURATION_WEIGHT;
+
+// MIDI CC learn
+static constexpr int NUM_CC_MAPPINGS = 32;     // Learned CCs per instance
+static constexpr int CC_ACTION_THRESHOLD = 64; // CC value that triggers a mapped action
+
+// Transpose modulator notes are relative to this note (C4)
+static constexpr int MOD_TRANSPOSE_CENTER = 60;
+
+// CV note input: 0 V on Pitch In is this note (C4); pitch is read this long
+// after the gate rises, once a sequencer's pitch output has settled
+static constexpr int CV_ZERO_VOLT_NOTE = 60;
+static constexpr float CV_PITCH_SETTLE_SECONDS = 0.001f;
+
+// Beat repeat: played steps remembered per track (covers the longest span, half a loop)
+static constexpr int REPEAT_HISTORY = MAX_STEPS / 2;
+
+// ============================================================================
+// METRONOME
+// ============================================================================
+
+static constexpr int BEATS_PER_BAR = 4;                 // Count-in bar length (matches the beat display)
+static constexpr float METRO_PULSE_SECONDS = 0.01f;     // CV click length (shortened at fast tempos)
+static constexpr float METRO_NOTE_SECONDS = 0.05f;      // MIDI click note length
+static constexpr float METRO_LEVEL_BEAT = 5.0f;         // CV click voltage
+static constexpr float METRO_LEVEL_ACCENT = 10.0f;      // CV click voltage on the downbeat
+static constexpr int METRO_VEL_BEAT = 90;               // MIDI click velocity
+static constexpr int METRO_VEL_ACCENT = 127;            // MIDI click velocity on the downbeat
+
+// ============================================================================
+// ANALYSIS
+// ============================================================================
+
+static constexpr int KEY_HIST_MAX_DURATION = MAX_STEPS; // Duration weight cap (keeps histogram in 32 bits)
+static constexpr float KEY_DISPLAY_SECONDS = 3.0f;      // How long a detected key stays on screen
 
 // ============================================================================
 // PARAMETER LAYOUT
 // ============================================================================
 
 static constexpr int PARAMS_PER_TRACK = 26; // Parameters per track
-static constexpr int GLOBAL_PARAMS = 23;    // Global parameters (Run Input, Clock Input, Record, Generate, Fill, etc.)
+static constexpr int GLOBAL_PARAMS = 33;    // Global parameters (Run Input, Clock Input, Record, Generate, Fill, etc.)
 
 // Derived constants (do not modify directly)
 static constexpr int MAX_TOTAL_PARAMS = GLOBAL_PARAMS + (PARAMS_PER_TRACK * MAX_TRACKS);
-static constexpr int MAX_PAGES = 4 + MAX_TRACKS; // Routing + Global + MIDI + Generate + track pages
+static constexpr int MAX_PAGES = 5 + MAX_TRACKS; // Routing + Global + MIDI + Generate + Edit + track pages
 
 // ============================================================================
 // ALGORITHM TUNING
@@ -72,9 +147,16 @@ static constexpr int BROWNIAN_DELTA_MAX = 2;
 
 // Ensure data types can hold configuration values
 static_assert(MAX_STEPS <= 255, "MAX_STEPS must fit in uint8_t (TrackCache, shuffleOrder)");
+static_assert((REPEAT_HISTORY & (REPEAT_HISTORY - 1)) == 0, "REPEAT_HISTORY must be a power of two");
+static_assert(NUM_CC_MAPPINGS <= 32, "NUM_CC_MAPPINGS must fit in the CcMap::pendingMask bits");
+static_assert(MAX_STEPS % 32 == 0, "MAX_STEPS must be a multiple of 32 (TrackState::skipMask)");
 static_assert(MAX_EVENTS_PER_STEP <= 255, "MAX_EVENTS_PER_STEP must fit in uint8_t");
 static_assert(MAX_TRACKS <= 255, "MAX_TRACKS must fit in uint8_t");
-static_assert(MAX_DELAYED_NOTES <= 65535, "MAX_DELAYED_NOTES must fit in uint16_t");
+static_assert(MAX_TRACKS <= 8, "MAX_TRACKS must fit in the uint8_t mute/solo/launch masks");
+static_assert(NUM_PATTERNS < 255, "NUM_PATTERNS must fit in uint8_t below LAUNCH_NONE");
+static_assert(MAX_DELAYED_NOTES <= 255, "MAX_DELAYED_NOTES must fit in uint8_t");
+static_assert(MAX_HELD_NOTES <= 255, "MAX_HELD_NOTES must fit in uint8_t");
+static_assert((CAPTURE_BUFFER_SIZE & (CAPTURE_BUFFER_SIZE - 1)) == 0, "CAPTURE_BUFFER_SIZE must be a power of two");
 
 // Ensure parameter indices fit within distingNT API limit (242 max parameters)
 static_assert(GLOBAL_PARAMS - 1 + PARAMS_PER_TRACK * MAX_TRACKS <= 242,
@@ -0,0 +1,73 @@
+/*
+ * MIDI Looper - CV Note Input
+ *
+ * Gate In is scanned frame by frame so each edge is timed to the frame it
+ * happened on rather than to the block. Pitch In (1 V/oct) is read
+ * CV_PITCH_SETTLE_SECONDS after the rising edge, which may fall in a later
+ * block, and rounded to the nearest note. The resulting note-on/off go
+ * through inputNote() exactly like MIDI input, carrying their sub-block
+ * stepTime, so scale quantization, thru, capture and every recording mode
+ * apply unchanged. The gate is monophonic: one note sounds at a time.
+ */
+
+#include "cvinput.h"
+#include "math.h"
+#include "recording.h"
+
+static void cvNoteOn(MidiLooperAlgorithm* alg, float pitchVolts, float stepTime) {
+    MidiLooper_DTC* dtc = alg->dtc;
+    int note = clamp(CV_ZERO_VOLT_NOTE + roundToInt(pitchVolts * 12.0f), 0, 127);
+    dtc->cvNote = (uint8_t)note;
+    inputNote(alg, (uint8_t)note, true, (uint8_t)dtc->settings[kSetCvVelocity], 0, stepTime);
+}
+
+static void cvNoteOff(MidiLooperAlgorithm* alg, float stepTime) {
+    MidiLooper_DTC* dtc = alg->dtc;
+    if (dtc->cvNote == CV_NOTE_NONE) return;
+    inputNote(alg, dtc->cvNote, false, 0, 0, stepTime);
+    dtc->cvNote = CV_NOTE_NONE;
+}
+
+void processCvInput(MidiLooperAlgorithm* alg, const float* busFrames, int numFrames) {
+    MidiLooper_DTC* dtc = alg->dtc;
+    int gateBus = alg->v[kParamCvGateInput];
+    if (gateBus == 0) {
+        // Input switched off: release what it was holding
+        dtc->cvSettle = 0;
+        dtc->cvGateHigh = false;
+        cvNoteOff(alg, dtc->stepTime);
+        return;
+    }
+
+    int pitchBus = alg->v[kParamPitchInput];
+    const float* gate = busFrames + (gateBus - 1) * numFrames;
+    const float* pitch = (pitchBus > 0) ? busFrames + (pitchBus - 1) * numFrames : NULL;
+    float frameTime = 1.0f / (float)NT_globals.sampleRate;
+    int settleFrames = (int)(CV_PITCH_SETTLE_SECONDS * (float)NT_globals.sampleRate) + 1;
+
+    for (int f = 0; f < numFrames; f++) {
+        // A clock may have passed since the rising edge (resetting
+        // stepTime), so the note is never placed later than now
+        float now = dtc->stepTime + (float)f * frameTime;
+        float edge = (dtc->cvEdgeTime < now) ? dtc->cvEdgeTime : now;
+
+        // Pitch has settled after the last rising edge
+        if (dtc->cvSettle > 0 && --dtc->cvSettle == 0) {
+            cvNoteOn(alg, pitch ? pitch[f] : 0.0f, edge);
+        }
+
+        if (!dtc->cvGateHigh && gate[f] > GATE_THRESHOLD_HIGH) {
+            dtc->cvGateHigh = true;
+            dtc->cvEdgeTime = now;
+            dtc->cvSettle = (uint16_t)settleFrames;
+        } else if (dtc->cvGateHigh && gate[f] < GATE_THRESHOLD_LOW) {
+            dtc->cvGateHigh = false;
+            if (dtc->cvSettle > 0) {
+                // Gate shorter than the settle time: take the pitch as it is
+                dtc->cvSettle = 0;
+                cvNoteOn(alg, pitch ? pitch[f] : 0.0f, edge);
+            }
+            cvNoteOff(alg, now);
+        }
+    }
+}
@@ -0,0 +1,11 @@
+/*
+ * MIDI Looper - CV Note Input
+ * Records pitch CV + gate into the same path as MIDI notes
+ */
+
+#pragma once
+
+#include "types.h"
+
+// Scan Gate In across the block (called from step() before stepTime advances)
+void processCvInput(MidiLooperAlgorithm* alg, const float* busFrames, int numFrames);
@@ -0,0 +1,222 @@
+/*
+ * MIDI Looper - Step Range Editing
+ *
+ * All operations move whole StepEvents blocks (events plus occupancy count)
+ * with memcpy/memmove rather than re-adding events one at a time, so even a
+ * full 128-step track copy is a single bulk move.
+ *
+ * Ranges and the paste position are positions in the track's loop window
+ * (position 1 = Loop Start), resolved through windowStep(); a window running
+ * past step 128 wraps to step 1, so a move takes at most three runs.
+ */
+
+#include "edit.h"
+#include <cstring>
+#include "math.h"
+#include "midi.h"
+#include "settings.h"
+
+// ============================================================================
+// BULK STEP MOVES
+// ============================================================================
+
+// Copy `count` steps between two step arrays of MAX_STEPS (0-based indices),
+// wrapping past the last step to the first
+static void moveSteps(StepEvents* dst, int dstIdx, const StepEvents* src, int srcIdx, int count) {
+    while (count > 0) {
+        int run = count;
+        if (run > MAX_STEPS - dstIdx) run = MAX_STEPS - dstIdx;
+        if (run > MAX_STEPS - srcIdx) run = MAX_STEPS - srcIdx;
+        memmove(&dst[dstIdx], &src[srcIdx], sizeof(StepEvents) * run);
+        dstIdx = (dstIdx + run) % MAX_STEPS;
+        srcIdx = (srcIdx + run) % MAX_STEPS;
+        count -= run;
+    }
+}
+
+// Step index (0-based) of a loop window position (1-based)
+static int windowIndex(const TrackState* ts, int pos) {
+    return windowStep(ts, pos) - 1;
+}
+
+// ============================================================================
+// OPERATIONS
+// ============================================================================
+
+static void copyToClipboard(MidiLooperAlgorithm* alg, const PendingEdit& edit) {
+    EditClipboard* clip = alg->clipboard;
+    const TrackState* ts = &alg->trackStates[edit.srcTrack];
+    int count = edit.end - edit.start + 1;
+    moveSteps(clip->steps, 0, ts->data->steps, windowIndex(ts, edit.start), count);
+    clip->length = (uint8_t)count;
+}
+
+static void pasteClipboard(MidiLooperAlgorithm* alg, const PendingEdit& edit, const EditClipboard* clip) {
+    if (clip->length == 0) return;
+
+    TrackState* ts = &alg->trackStates[edit.dstTrack];
+    int count = clip->length;
+    if (edit.destStep - 1 + count > MAX_STEPS) count = MAX_STEPS - (edit.destStep - 1);
+    moveSteps(ts->data->steps, windowIndex(ts, edit.destStep), clip->steps, 0, count);
+}
+
+// Repeat the range immediately after itself (up to window position 128)
+static void duplicateRange(MidiLooperAlgorithm* alg, const PendingEdit& edit) {
+    TrackState* ts = &alg->trackStates[edit.srcTrack];
+    int count = edit.end - edit.start + 1;
+    if (edit.end + count > MAX_STEPS) count = MAX_STEPS - edit.end;
+    if (count <= 0) return;
+    moveSteps(ts->data->steps, windowIndex(ts, edit.end + 1), ts->data->steps, windowIndex(ts, edit.start), count);
+}
+
+// Copy the loop window, skipped steps included, after itself and double the
+// track length
+static void doubleLoop(MidiLooperAlgorithm* alg, const PendingEdit& edit) {
+    int track = edit.srcTrack;
+    int loopLen = TrackParams::fromAlgorithm(alg->v, track).length();
+    if (loopLen * 2 > MAX_STEPS) return;
+
+    TrackState* ts = &alg->trackStates[track];
+    moveSteps(ts->data->steps, windowIndex(ts, loopLen + 1), ts->data->steps, windowIndex(ts, 1), loopLen);
+    for (int pos = 1; pos <= loopLen; pos++) {
+        setStepSkipped(ts, windowIndex(ts, loopLen + pos), stepSkipped(ts, windowIndex(ts, pos)));
+    }
+    setParameterValue(alg, trackParam(track, kTrackLength), loopLen * 2);
+}
+
+// Copy all steps, the skips and the loop window to the destination track
+static void copyTrack(MidiLooperAlgorithm* alg, const PendingEdit& edit) {
+    if (edit.dstTrack == edit.srcTrack) return;
+
+    const TrackState* src = &alg->trackStates[edit.srcTrack];
+    TrackState* dst = &alg->trackStates[edit.dstTrack];
+    memcpy(dst->data, src->data, sizeof(TrackData));
+    memcpy(dst->skipMask, src->skipMask, sizeof(dst->skipMask));
+    dst->stepMapDirty = true;
+    setTrackSetting(alg, edit.dstTrack, kTrkSetLoopStart, src->settings[kTrkSetLoopStart]);
+    alg->dtc->settingSyncPending = true;
+    int loopLen = TrackParams::fromAlgorithm(alg->v, edit.srcTrack).length();
+    setParameterValue(alg, trackParam(edit.dstTrack, kTrackLength), loopLen);
+}
+
+// Drop the range from (or return it to) the playback walk; the events stay
+static void skipRange(MidiLooperAlgorithm* alg, const PendingEdit& edit, bool skip) {
+    TrackState* ts = &alg->trackStates[edit.srcTrack];
+    for (int pos = edit.start; pos <= edit.end; pos++) {
+        setStepSkipped(ts, windowIndex(ts, pos), skip);
+    }
+}
+
+// `clip` is what a Paste reads: the clipboard, or the snapshot taken when a
+// deferred Paste was requested
+static void applyEdit(MidiLooperAlgorithm* alg, const PendingEdit& edit, const EditClipboard* clip) {
+    if (edit.action != ACTION_COPY && edit.action != ACTION_SKIP && edit.action != ACTION_UNSKIP) {
+        markTrackEdited(&alg->trackStates[edit.dstTrack]);
+        markTrackEdited(&alg->trackStates[edit.srcTrack]);
+    }
+
+    switch (edit.action) {
+    case ACTION_COPY:
+        copyToClipboard(alg, edit);
+        break;
+    case ACTION_PASTE:
+        pasteClipboard(alg, edit, clip);
+        break;
+    case ACTION_DUPLICATE:
+        duplicateRange(alg, edit);
+        break;
+    case ACTION_DOUBLE:
+        doubleLoop(alg, edit);
+        break;
+    case ACTION_COPY_TRACK:
+        copyTrack(alg, edit);
+        break;
+    case ACTION_SKIP:
+        skipRange(alg, edit, true);
+        break;
+    case ACTION_UNSKIP:
+        skipRange(alg, edit, false);
+        break;
+    }
+}
+
+// ============================================================================
+// DEFERRED EDITS
+// ============================================================================
+
+// Queue an edit for its destination's next wrap. A Paste takes its own copy of
+// the clipboard now, so a Copy made before the wrap doesn't change what lands.
+// Each track keeps one such copy, so a second Paste replaces the one waiting
+// (and moves to the end of the queue); an edit past a full queue is dropped.
+// Nothing is applied before the wrap.
+static void queueEdit(MidiLooperAlgorithm* alg, const PendingEdit& edit) {
+    int track = edit.dstTrack;
+    EditQueue* queue = &alg->editQueues[track];
+    bool paste = (edit.action == ACTION_PASTE);
+    if (paste && queue->pastePending) {
+        int kept = 0;
+        for (int i = 0; i < queue->count; i++) {
+            if (queue->edits[i].action != ACTION_PASTE) queue->edits[kept++] = queue->edits[i];
+        }
+        queue->count = (uint8_t)kept;
+        queue->pastePending = false;
+    }
+    if (queue->count == EDIT_QUEUE_DEPTH) return;
+
+    if (paste) {
+        EditClipboard* snapshot = &alg->pasteClips[track];
+        snapshot->length = alg->clipboard->length;
+        memcpy(snapshot->steps, alg->clipboard->steps, sizeof(StepEvents) * snapshot->length);
+        queue->pastePending = true;
+    }
+    queue->edits[queue->count++] = edit;
+}
+
+// ============================================================================
+// ENTRY POINTS
+// ============================================================================
+
+void executeEditAction(MidiLooperAlgorithm* alg, int action) {
+    int srcTrack = clampParam(alg->v[kParamRecTrack], 0, alg->numTracks - 1);
+    int loopLen = TrackParams::fromAlgorithm(alg->v, srcTrack).length();
+
+    // Resolve the range and destination (loop window positions) from settings
+    int start = getSetting(alg, kSetRangeStart);
+    int end = getSetting(alg, kSetRangeEnd);
+    if (end == 0) end = loopLen;
+    if (start > end) start = end;
+
+    int destTrack = getSetting(alg, kSetDestTrack);
+    int dstTrack = (destTrack > 0) ? clampParam(destTrack - 1, 0, alg->numTracks - 1) : srcTrack;
+    int destStep = getSetting(alg, kSetDestStep);
+    if (destStep == 0) destStep = start;
+
+    PendingEdit edit;
+    edit.action = (uint8_t)action;
+    edit.srcTrack = (uint8_t)srcTrack;
+    edit.dstTrack = (uint8_t)dstTrack;
+    edit.start = (uint8_t)start;
+    edit.end = (uint8_t)end;
+    edit.destStep = (uint8_t)destStep;
+
+    // Copy only reads; everything else may wait for the destination's wrap
+    bool deferred = (action != ACTION_COPY) && getSetting(alg, kSetEditQuant) == EDIT_QUANT_LOOP &&
+                    transportIsRunning(alg->dtc->transportState);
+    if (deferred) {
+        if (action != ACTION_PASTE && action != ACTION_COPY_TRACK) edit.dstTrack = edit.srcTrack;
+        queueEdit(alg, edit);
+        return;
+    }
+
+    applyEdit(alg, edit, alg->clipboard);
+}
+
+void applyPendingEdits(MidiLooperAlgorithm* alg, int track) {
+    EditQueue* queue = &alg->editQueues[track];
+    int count = queue->count;
+    queue->count = 0;
+    queue->pastePending = false;
+    for (int i = 0; i < count; i++) {
+        applyEdit(alg, queue->edits[i], &alg->pasteClips[track]);
+    }
+}
@@ -0,0 +1,14 @@
+/*
+ * MIDI Looper - Step Range Editing
+ * Copy, paste, duplicate and double-length operations
+ */
+
+#pragma once
+
+#include "types.h"
+
+// Run the edit selected by the Action parameter (immediately or at the next wrap)
+void executeEditAction(MidiLooperAlgorithm* alg, int action);
+
+// Apply a track's deferred edits when it wraps
+void applyPendingEdits(MidiLooperAlgorithm* alg, int track);
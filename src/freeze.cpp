@@ -0,0 +1,174 @@
+/*
+ * MIDI Looper - Freeze
+ *
+ * Freeze runs the source track's step pipeline (direction, modifiers, trig
+ * conditions, probabilities, octave jumps) offline, from a copy of its PRNG
+ * state taken when Freeze is executed, and writes what it would have played
+ * one step per clock into a render buffer. Rendering is time-sliced
+ * (FREEZE_CLOCKS_PER_BLOCK clocks per step() call) and runs on its own
+ * PlayCursor swapped into the track around each slice, so live playback never
+ * sees it. The result replaces the destination track, set to play Forward
+ * with modifiers off.
+ *
+ * The render only runs the track's own pipeline, so a track whose output also
+ * depends on other tracks (Follow, Dep Track, being or receiving a modulator)
+ * or on a held Beat Repeat can't be frozen: Freeze refuses to start, and a
+ * render is dropped if the track gains such a link before it finishes.
+ */
+
+#include "freeze.h"
+#include <cstring>
+#include "midi.h"
+#include "playback.h"
+#include "settings.h"
+
+// ============================================================================
+// PLAY CURSOR SWAP
+// ============================================================================
+
+template <typename T> static inline void swapValue(T& a, T& b) {
+    T tmp = a;
+    a = b;
+    b = tmp;
+}
+
+// Exchange the track's playback state with the render cursor
+static void swapCursor(TrackState* ts, PlayCursor* c) {
+    swapValue(ts->randState, c->randState);
+    swapValue(ts->clockCount, c->clockCount);
+    swapValue(ts->loopCount, c->loopCount);
+    swapValue(ts->octavePlayCount, c->octavePlayCount);
+    swapValue(ts->step, c->step);
+    swapValue(ts->walkPos, c->walkPos);
+    swapValue(ts->lastStep, c->lastStep);
+    swapValue(ts->brownianPos, c->brownianPos);
+    swapValue(ts->shufflePos, c->shufflePos);
+    uint8_t order[MAX_STEPS];
+    memcpy(order, ts->shuffleOrder, sizeof(order));
+    memcpy(ts->shuffleOrder, c->shuffleOrder, sizeof(order));
+    memcpy(c->shuffleOrder, order, sizeof(order));
+}
+
+// ============================================================================
+// FREEZE
+// ============================================================================
+
+// True when the track's own pipeline is all there is to its output
+static bool renderable(MidiLooperAlgorithm* alg, int track) {
+    const TrackState* ts = &alg->trackStates[track];
+    if (ts->leader >= 0 || ts->depTrack >= 0 || ts->modulates) return false;
+    if (alg->v[kParamBeatRepeat] != 0 && ts->settings[kTrkSetRepeat]) return false;
+    for (int t = 0; t < alg->numTracks; t++) {
+        const TrackState* mod = &alg->trackStates[t];
+        if (t != track && mod->modulates && ((mod->modDest >> track) & 1)) return false;
+    }
+    return true;
+}
+
+void startFreeze(MidiLooperAlgorithm* alg) {
+    FreezeJob* job = &alg->freezeJob;
+    if (job->active) return;
+
+    int srcTrack = clampParam(alg->v[kParamRecTrack], 0, alg->numTracks - 1);
+    if (!renderable(alg, srcTrack)) return;
+    int destTrack = getSetting(alg, kSetDestTrack);
+    int dstTrack = (destTrack > 0) ? clampParam(destTrack - 1, 0, alg->numTracks - 1) : srcTrack;
+
+    // As many of the requested loops as fit in MAX_STEPS (at least one)
+    int loopLen = TrackParams::fromAlgorithm(alg->v, srcTrack).length();
+    int loops = getSetting(alg, kSetFreezeLoops);
+    if (loops * loopLen > MAX_STEPS) loops = MAX_STEPS / loopLen;
+
+    FreezeBuffer* buf = alg->freeze;
+    for (int s = 0; s < MAX_STEPS; s++) {
+        buf->data.steps[s].count = 0;
+    }
+
+    // Render starts as playback does on transport start, from the track's
+    // current PRNG state
+    PlayCursor* c = &buf->cursor;
+    c->randState = alg->trackStates[srcTrack].randState;
+    c->clockCount = 0;
+    c->loopCount = 0;
+    c->octavePlayCount = 0;
+    c->step = 0;
+    c->walkPos = 0;
+    c->lastStep = 1;
+    c->brownianPos = 1;
+    c->shufflePos = 1;
+    for (int s = 0; s < MAX_STEPS; s++) {
+        c->shuffleOrder[s] = (uint8_t)(s + 1);
+    }
+
+    job->clock = 0;
+    job->length = (uint16_t)(loops * loopLen);
+    job->srcTrack = (uint8_t)srcTrack;
+    job->dstTrack = (uint8_t)dstTrack;
+    job->active = true;
+}
+
+// Replace the destination with the rendered events, set to play them back as-is
+static void commitFreeze(MidiLooperAlgorithm* alg) {
+    FreezeJob* job = &alg->freezeJob;
+    int src = job->srcTrack;
+    int dst = job->dstTrack;
+    TrackParams srcParams = TrackParams::fromAlgorithm(alg->v, src);
+    int clockDiv = srcParams.clockDiv();
+
+    TrackState* ts = &alg->trackStates[dst];
+    memcpy(ts->data, &alg->freeze->data, sizeof(TrackData));
+    markTrackEdited(ts);
+
+    // The render already went through the source's loop window and skips;
+    // the destination plays on its own, without links to other tracks
+    memset(ts->skipMask, 0, sizeof(ts->skipMask));
+    ts->stepMapDirty = true;
+    setTrackSetting(alg, dst, kTrkSetLoopStart, 1);
+    setTrackSetting(alg, dst, kTrkSetFollow, 0);
+    setTrackSetting(alg, dst, kTrkSetDepTrack, 0);
+    setTrackSetting(alg, dst, kTrkSetModType, MOD_OFF);
+    setTrackSetting(alg, dst, kTrkSetRepeat, 0);
+    alg->dtc->settingSyncPending = true;
+
+    setParameterValue(alg, trackParam(dst, kTrackLength), job->length);
+    setParameterValue(alg, trackParam(dst, kTrackClockDiv), clockDiv);
+    setParameterValue(alg, trackParam(dst, kTrackDirection), DIR_FORWARD);
+    setParameterValue(alg, trackParam(dst, kTrackVelocity), 0);
+    setParameterValue(alg, trackParam(dst, kTrackHumanize), 0);
+    setParameterValue(alg, trackParam(dst, kTrackStability), 0);
+    setParameterValue(alg, trackParam(dst, kTrackMotion), 0);
+    setParameterValue(alg, trackParam(dst, kTrackRandomness), 0);
+    setParameterValue(alg, trackParam(dst, kTrackPedal), 0);
+    setParameterValue(alg, trackParam(dst, kTrackNoRepeat), 0);
+    setParameterValue(alg, trackParam(dst, kTrackOctMin), 0);
+    setParameterValue(alg, trackParam(dst, kTrackOctMax), 0);
+    setParameterValue(alg, trackParam(dst, kTrackOctProb), 0);
+    setParameterValue(alg, trackParam(dst, kTrackStepProb), 100);
+    setParameterValue(alg, trackParam(dst, kTrackStepCond), COND_ALWAYS);
+    setParameterValue(alg, trackParam(dst, kTrackCondStepA), 0);
+    setParameterValue(alg, trackParam(dst, kTrackCondStepB), 0);
+
+    job->active = false;
+}
+
+void processFreeze(MidiLooperAlgorithm* alg) {
+    FreezeJob* job = &alg->freezeJob;
+    if (!job->active) return;
+    if (!renderable(alg, job->srcTrack)) {
+        job->active = false;
+        return;
+    }
+
+    FreezeBuffer* buf = alg->freeze;
+    TrackState* ts = &alg->trackStates[job->srcTrack];
+
+    swapCursor(ts, &buf->cursor);
+    for (int i = 0; i < FREEZE_CLOCKS_PER_BLOCK && job->clock < job->length; i++, job->clock++) {
+        renderTrackClock(alg, job->srcTrack, &buf->data.steps[job->clock]);
+    }
+    swapCursor(ts, &buf->cursor);
+
+    if (job->clock >= job->length) {
+        commitFreeze(alg);
+    }
+}
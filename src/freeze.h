@@ -0,0 +1,11 @@
+/*
+ * MIDI Looper - Freeze
+ * Render a track's actual output into plain Forward-playing events
+ */
+
+#pragma once
+
+#include "types.h"
+
+void startFreeze(MidiLooperAlgorithm* alg);
+void processFreeze(MidiLooperAlgorithm* alg);
@@ -26,13 +26,11 @@ static void generateNew(MidiLooperAlgorithm* alg, int track) {
     int velVar = v[kParamGenVelVar];
     int ties = v[kParamGenTies];
     int gateRand = v[kParamGenGateRand];
-    int scaleRoot = v[kParamScaleRoot];
-    int scaleType = v[kParamScaleType];
 
     int loopLen;
     int quantize = getCachedQuantize(v, track, &ts->cache, loopLen);
 
-    clearTrackEvents(&ts->data);
+    clearTrackEvents(ts);
 
     for (int s = 1; s <= loopLen; s++) {
         // Only place notes on division boundaries
@@ -49,8 +47,7 @@ static void generateNew(MidiLooperAlgorithm* alg, int track) {
         } else {
             note = bias;
         }
-        note = clamp(note, 0, 127);
-        note = quantizeToScale((uint8_t)note, scaleRoot, scaleType);
+        note = quantizeNote(alg, clamp(note, 0, 127));
 
         // Velocity: centered around 100, varied by velVar
         int velSpread = (100 * velVar) / 200; // half-range
@@ -68,13 +65,13 @@ static void generateNew(MidiLooperAlgorithm* alg, int track) {
         uint16_t dur = (uint16_t)durVal;
 
         int idx = safeStepIndex(s - 1);
-        addEvent(&ts->data.steps[idx], (uint8_t)note, (uint8_t)vel, dur);
+        addEvent(&ts->data->steps[idx], (uint8_t)note, (uint8_t)vel, dur);
     }
 
     // Pass 2: Ties - extend note duration to reach the next note
     if (ties > 0) {
         for (int s = 0; s < loopLen; s++) {
-            StepEvents* evs = &ts->data.steps[s];
+            StepEvents* evs = &ts->data->steps[s];
             if (evs->count == 0) continue;
             if (randRange(ts->randState, 1, 100) > ties) continue;
 
@@ -82,7 +79,7 @@ static void generateNew(MidiLooperAlgorithm* alg, int track) {
             int dist = 0;
             for (int d = 1; d <= loopLen - 1; d++) {
                 int nextIdx = (s + d) % loopLen;
-                if (ts->data.steps[nextIdx].count > 0) {
+                if (ts->data->steps[nextIdx].count > 0) {
                     dist = d;
                     break;
                 }
@@ -117,7 +114,7 @@ static void generateReorder(MidiLooperAlgorithm* alg, int track) {
     int count = 0;
 
     for (int s = 0; s < loopLen && count < 128; s++) {
-        StepEvents* evs = &ts->data.steps[s];
+        StepEvents* evs = &ts->data->steps[s];
         for (int e = 0; e < evs->count && count < 128; e++) {
             collected[count].note = evs->events[e].note;
             collected[count].velocity = evs->events[e].velocity;
@@ -132,7 +129,7 @@ static void generateReorder(MidiLooperAlgorithm* alg, int track) {
     int positions[128];
     int posCount = 0;
     for (int s = 0; s < loopLen && posCount < 128; s++) {
-        if (ts->data.steps[s].count > 0) {
+        if (ts->data->steps[s].count > 0) {
             positions[posCount++] = s;
         }
     }
@@ -146,11 +143,11 @@ static void generateReorder(MidiLooperAlgorithm* alg, int track) {
     }
 
     // Clear and redistribute
-    clearTrackEvents(&ts->data);
+    clearTrackEvents(ts);
     int noteIdx = 0;
     for (int p = 0; p < posCount && noteIdx < count; p++) {
         int s = positions[p];
-        addEvent(&ts->data.steps[s], collected[noteIdx].note, collected[noteIdx].velocity, collected[noteIdx].duration);
+        addEvent(&ts->data->steps[s], collected[noteIdx].note, collected[noteIdx].velocity, collected[noteIdx].duration);
         noteIdx++;
     }
 }
@@ -166,8 +163,6 @@ static void generateRepitch(MidiLooperAlgorithm* alg, int track) {
     int bias = v[kParamGenBias];
     int range = v[kParamGenRange];
     int noteRand = v[kParamGenNoteRand];
-    int scaleRoot = v[kParamScaleRoot];
-    int scaleType = v[kParamScaleType];
 
     int loopLen;
     getCachedQuantize(v, track, &ts->cache, loopLen);
@@ -175,7 +170,7 @@ static void generateRepitch(MidiLooperAlgorithm* alg, int track) {
     int spread = (range * noteRand) / 100;
 
     for (int s = 0; s < loopLen; s++) {
-        StepEvents* evs = &ts->data.steps[s];
+        StepEvents* evs = &ts->data->steps[s];
         for (int e = 0; e < evs->count; e++) {
             int note;
             if (spread > 0) {
@@ -183,13 +178,123 @@ static void generateRepitch(MidiLooperAlgorithm* alg, int track) {
             } else {
                 note = bias;
             }
-            note = clamp(note, 0, 127);
-            note = quantizeToScale((uint8_t)note, scaleRoot, scaleType);
+            note = quantizeNote(alg, clamp(note, 0, 127));
             evs->events[e].note = (uint8_t)note;
         }
     }
 }
 
+// ============================================================================
+// MODE: CHORD - Re-pitch whole voicings, keep intervals
+// ============================================================================
+
+// Sort a step's event indices by note (insertion sort, at most 8 entries)
+static void sortVoicing(const StepEvents* evs, uint8_t* order) {
+    for (int i = 0; i < evs->count; i++) {
+        order[i] = (uint8_t)i;
+    }
+    for (int i = 1; i < evs->count; i++) {
+        uint8_t idx = order[i];
+        int j = i - 1;
+        while (j >= 0 && evs->events[order[j]].note > evs->events[idx].note) {
+            order[j + 1] = order[j];
+            j--;
+        }
+        order[j + 1] = idx;
+    }
+}
+
+// Total semitone movement from the previous voicing, pairing voices by rank.
+// Voices without a partner are compared against the previous top voice.
+static int voiceMovement(const int* notes, int count, const int* prev, int prevCount) {
+    int total = 0;
+    for (int i = 0; i < count; i++) {
+        int p = prev[(i < prevCount) ? i : prevCount - 1];
+        total += (notes[i] > p) ? notes[i] - p : p - notes[i];
+    }
+    return total;
+}
+
+// Transpose a sorted voicing onto `shift`, rotated by `inv` voices (inversion).
+// Voice i of the result comes from event order[(i + inv) % count].
+static void buildVoicing(const StepEvents* evs, const uint8_t* order, int inv, int shift, int* out) {
+    int count = evs->count;
+    int low = evs->events[order[0]].note;
+    for (int i = 0; i < count; i++) {
+        int k = i + inv;
+        int octave = (k >= count) ? 12 : 0;  // Rotated voices move up an octave
+        out[i] = evs->events[order[k % count]].note - low + shift + octave;
+    }
+}
+
+// Each step's events are treated as one voicing: a new root is drawn per step
+// and the voicing's intervals are transposed onto it. With voice leading, the
+// inversion and octave closest to the previous step's voicing are chosen.
+static void generateChordRepitch(MidiLooperAlgorithm* alg, int track, bool voiceLead) {
+    const int16_t* v = alg->v;
+    TrackState* ts = &alg->trackStates[track];
+
+    int bias = v[kParamGenBias];
+    int range = v[kParamGenRange];
+    int noteRand = v[kParamGenNoteRand];
+
+    int loopLen;
+    getCachedQuantize(v, track, &ts->cache, loopLen);
+
+    int spread = (range * noteRand) / 100;
+
+    int prev[MAX_EVENTS_PER_STEP];
+    int prevCount = 0;
+
+    for (int s = 0; s < loopLen; s++) {
+        StepEvents* evs = &ts->data->steps[s];
+        int count = evs->count;
+        if (count == 0) continue;
+
+        uint8_t order[MAX_EVENTS_PER_STEP];
+        sortVoicing(evs, order);
+
+        int root = (spread > 0) ? bias + randRange(ts->randState, -spread, spread) : bias;
+
+        // Candidates: the drawn root only, or every inversion an octave
+        // either side of it when leading from a previous voicing
+        bool lead = voiceLead && prevCount > 0;
+        int numInversions = lead ? count : 1;
+        int octaveSpan = lead ? 1 : 0;
+        int bestInv = 0;
+        int bestShift = root;
+        int bestCost = -1;
+        for (int inv = 0; inv < numInversions; inv++) {
+            for (int oct = -octaveSpan; oct <= octaveSpan; oct++) {
+                int cand[MAX_EVENTS_PER_STEP];
+                buildVoicing(evs, order, inv, root + oct * 12, cand);
+                int cost = lead ? voiceMovement(cand, count, prev, prevCount) : 0;
+                if (bestCost < 0 || cost < bestCost) {
+                    bestCost = cost;
+                    bestInv = inv;
+                    bestShift = root + oct * 12;
+                }
+            }
+        }
+
+        int notes[MAX_EVENTS_PER_STEP];
+        buildVoicing(evs, order, bestInv, bestShift, notes);
+
+        // Rewrite the step, keeping each voice's velocity and duration and
+        // dropping notes that collapse together after scale quantization
+        StepEvents src = *evs;
+        evs->count = 0;
+        prevCount = 0;
+        for (int i = 0; i < count; i++) {
+            const NoteEvent& ev = src.events[order[(i + bestInv) % count]];
+            uint8_t note = quantizeNote(alg, clamp(notes[i], 0, 127));
+            if (addEvent(evs, note, ev.velocity, ev.duration)) {
+                prev[prevCount++] = note;
+            }
+        }
+    }
+}
+
 // ============================================================================
 // MODE: INVERT - Reverse step sequence in-place
 // ============================================================================
@@ -204,21 +309,21 @@ static void generateInvert(MidiLooperAlgorithm* alg, int track) {
     int right = loopLen - 1;
     while (left < right) {
         // Swap steps[left] and steps[right]
-        StepEvents tmp = ts->data.steps[left];
-        ts->data.steps[left] = ts->data.steps[right];
-        ts->data.steps[right] = tmp;
+        StepEvents tmp = ts->data->steps[left];
+        ts->data->steps[left] = ts->data->steps[right];
+        ts->data->steps[right] = tmp;
 
         // Clamp durations to remaining loop space from new position
-        for (int e = 0; e < ts->data.steps[left].count; e++) {
+        for (int e = 0; e < ts->data->steps[left].count; e++) {
             uint16_t maxDur = (uint16_t)(loopLen - left);
-            if (ts->data.steps[left].events[e].duration > maxDur) {
-                ts->data.steps[left].events[e].duration = maxDur;
+            if (ts->data->steps[left].events[e].duration > maxDur) {
+                ts->data->steps[left].events[e].duration = maxDur;
             }
         }
-        for (int e = 0; e < ts->data.steps[right].count; e++) {
+        for (int e = 0; e < ts->data->steps[right].count; e++) {
             uint16_t maxDur = (uint16_t)(loopLen - right);
-            if (ts->data.steps[right].events[e].duration > maxDur) {
-                ts->data.steps[right].events[e].duration = maxDur;
+            if (ts->data->steps[right].events[e].duration > maxDur) {
+                ts->data->steps[right].events[e].duration = maxDur;
             }
         }
 
@@ -250,5 +355,12 @@ void executeGenerate(MidiLooperAlgorithm* alg, int track) {
     case GEN_MODE_INVERT:
         generateInvert(alg, track);
         break;
+    case GEN_MODE_CHORD:
+        generateChordRepitch(alg, track, false);
+        break;
+    case GEN_MODE_CHORD_VL:
+        generateChordRepitch(alg, track, true);
+        break;
     }
+    markTrackEdited(&alg->trackStates[track]);
 }
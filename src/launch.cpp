@@ -0,0 +1,132 @@
+/*
+ * MIDI Looper - Pattern Launch
+ *
+ * Each track owns NUM_PATTERNS slots of step data in DRAM; TrackState::data
+ * points at the one playing. A note on the Launch Ch picks a (track, slot)
+ * pair and records it as the track's pending launch. The switch happens on
+ * the track's next wrap (tested in processTrack() with one compare) or on the
+ * clock that starts the Rec Track's next bar, and is just a pointer swap, so
+ * nothing is copied on the audio path. With the transport stopped, launches
+ * are immediate.
+ *
+ * Recording, editing and generation always work on the playing slot.
+ */
+
+#include "launch.h"
+#include "metronome.h"
+#include "midi.h"
+#include "quantize.h"
+
+bool launchNoteMessage(MidiLooperAlgorithm* alg, uint8_t status, uint8_t channel, uint8_t note, uint8_t velocity) {
+    int launchCh = alg->dtc->settings[kSetLaunchCh];
+    if (launchCh == 0 || channel != launchCh - 1) return false;
+    if (status != kMidiNoteOn && status != kMidiNoteOff) return false;
+
+    int index = note - alg->dtc->settings[kSetLaunchNote];
+    if (index < 0 || index >= alg->numTracks * NUM_PATTERNS) return false;
+
+    if (status == kMidiNoteOn && velocity > 0) {
+        requestLaunch(alg, index / NUM_PATTERNS, index % NUM_PATTERNS);
+    }
+    return true;
+}
+
+void requestLaunch(MidiLooperAlgorithm* alg, int track, int slot) {
+    MidiLooper_DTC* dtc = alg->dtc;
+    TrackState* ts = &alg->trackStates[track];
+    uint8_t bit = (uint8_t)(1u << track);
+
+    if (slot == ts->pattern) {
+        ts->launchSlot = LAUNCH_NONE;
+        dtc->launchBarMask &= (uint8_t)~bit;
+    } else {
+        ts->launchSlot = (uint8_t)slot;
+        if (dtc->settings[kSetLaunchQuant] == LAUNCH_QUANT_BAR) {
+            dtc->launchBarMask |= bit;
+        } else {
+            dtc->launchBarMask &= (uint8_t)~bit;
+        }
+    }
+
+}
+
+void switchPattern(MidiLooperAlgorithm* alg, int track) {
+    TrackState* ts = &alg->trackStates[track];
+    if (ts->launchSlot == LAUNCH_NONE) return;
+
+    int slot = ts->launchSlot;
+    ts->data = patternSlot(alg->patterns, track, slot);
+    ts->launchSlot = LAUNCH_NONE;
+    alg->dtc->launchBarMask &= (uint8_t)~(1u << track);
+    markTrackEdited(ts);
+
+    // Each slot has its own Program/Bank (sent ahead by processProgramChanges);
+    // the playing slot's live in settings
+    ts->slotProgram[ts->pattern] = ts->settings[kTrkSetProgram];
+    ts->slotBank[ts->pattern] = ts->settings[kTrkSetBank];
+    ts->settings[kTrkSetProgram] = ts->slotProgram[slot];
+    ts->settings[kTrkSetBank] = ts->slotBank[slot];
+    ts->pattern = (uint8_t)slot;
+    alg->dtc->settingSyncPending = true;
+}
+
+void processPatternLaunch(MidiLooperAlgorithm* alg, bool clockEdge) {
+    MidiLooper_DTC* dtc = alg->dtc;
+
+    if (!transportIsRunning(dtc->transportState)) {
+        for (int t = 0; t < alg->numTracks; t++) {
+            switchPattern(alg, t);
+        }
+        dtc->launchBarDue = false;
+        return;
+    }
+
+    if (clockEdge && dtc->launchBarDue) {
+        dtc->launchBarDue = false;
+        uint8_t pending = dtc->launchBarMask;
+        for (int t = 0; pending != 0; t++, pending >>= 1) {
+            if (pending & 1) switchPattern(alg, t);
+        }
+    }
+}
+
+// Input clocks until `track` has ticked `ticks` more times (followers tick with their leader)
+static uint32_t clocksToTick(MidiLooperAlgorithm* alg, int track, uint32_t ticks) {
+    const TrackState* ts = &alg->trackStates[track];
+    int src = (ts->leader >= 0) ? ts->leader : track;
+    uint32_t clockDiv = (uint32_t)TrackParams::fromAlgorithm(alg->v, src).clockDiv();
+    return (clockDiv - alg->trackStates[src].divCounter) + (ticks - 1) * clockDiv;
+}
+
+// Seconds until the track's pending launch switches in, from the clock rate.
+// A bar launch applies on the clock after the Rec Track's bar ends; a wrap
+// launch is taken to come a loop's worth of steps after the last wrap (exact
+// for Forward and Reverse, an estimate for directions that wrap irregularly).
+float launchTimeLeft(MidiLooperAlgorithm* alg, int track) {
+    MidiLooper_DTC* dtc = alg->dtc;
+    uint32_t clocks;
+    if ((dtc->launchBarMask >> track) & 1) {
+        int rec = clampParam(alg->v[kParamRecTrack], 0, alg->numTracks - 1);
+        TrackState* ts = &alg->trackStates[rec];
+        int loopLen;
+        int quantize = getCachedQuantize(alg->v, rec, &ts->cache, loopLen);
+        uint32_t bar = (uint32_t)(quantize > 0 ? quantize : 1) * BEATS_PER_BAR;
+        clocks = dtc->launchBarDue ? 1 : clocksToTick(alg, rec, bar - ts->clockCount % bar) + 1;
+    } else {
+        const TrackState* ts = &alg->trackStates[track];
+        const TrackState* lead = (ts->leader >= 0) ? &alg->trackStates[ts->leader] : ts;
+        uint32_t walkLen = lead->walkLen > 0 ? lead->walkLen : 1;
+        uint32_t count = lead->clockCount;
+        uint32_t ticks = (count == 0) ? walkLen + 1 : walkLen - (count - 1) % walkLen;
+        clocks = clocksToTick(alg, track, ticks);
+    }
+    return (float)clocks * dtc->stepDuration - dtc->stepTime;
+}
+
+// After a clock: note when the Rec Track has just finished a bar
+void launchClockProcessed(MidiLooperAlgorithm* alg) {
+    MidiLooper_DTC* dtc = alg->dtc;
+    if (dtc->launchBarMask && recTrackSpanEnded(alg, SPAN_BAR)) {
+        dtc->launchBarDue = true;
+    }
+}
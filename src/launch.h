@@ -0,0 +1,29 @@
+/*
+ * MIDI Looper - Pattern Launch
+ * Per-track pattern slots launched from MIDI notes, switched by pointer swap
+ */
+
+#pragma once
+
+#include "types.h"
+
+// Called from midiMessage(): returns true if the message was a launch note
+bool launchNoteMessage(MidiLooperAlgorithm* alg, uint8_t status, uint8_t channel, uint8_t note, uint8_t velocity);
+
+// Queue `slot` to play on `track` (cancels a pending launch if it's already playing)
+void requestLaunch(MidiLooperAlgorithm* alg, int track, int slot);
+
+// Make the track's pending slot the playing one
+void switchPattern(MidiLooperAlgorithm* alg, int track);
+
+// Seconds until the track's pending launch switches in (estimated from the clock rate)
+float launchTimeLeft(MidiLooperAlgorithm* alg, int track);
+
+// Quantized apply (called from step())
+void processPatternLaunch(MidiLooperAlgorithm* alg, bool clockEdge);
+void launchClockProcessed(MidiLooperAlgorithm* alg);
+
+// A launch switching in at this track's next wrap (checked by processTrack())
+static inline bool launchWaitsForWrap(const MidiLooper_DTC* dtc, const TrackState* ts, int track) {
+    return ts->launchSlot != LAUNCH_NONE && !((dtc->launchBarMask >> track) & 1);
+}
@@ -54,6 +54,11 @@ static inline float clampf(float x, float lo, float hi) {
     return x;
 }
 
+// Round to the nearest integer (halves away from zero) without libm
+static inline int roundToInt(float x) {
+    return (int)(x >= 0.0f ? x + 0.5f : x - 0.5f);
+}
+
 // ============================================================================
 // SAFE ARRAY ACCESS HELPERS
 // ============================================================================
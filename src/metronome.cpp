@@ -0,0 +1,199 @@
+/*
+ * MIDI Looper - Count-In and Metronome
+ *
+ * Beats follow the Rec Track's record grid (Rec Division), the same beats the
+ * four squares on the display show. Clicks are triggered from clock edges:
+ * the CV trigger starts on the exact frame of the edge within the block, its
+ * length is capped by the clock period estimate, and the downbeat is accented.
+ */
+
+#include "metronome.h"
+#include "midi.h"
+#include "midi_utils.h"
+#include "quantize.h"
+#include "recording.h"
+
+// Rec Track clocks per metronome beat
+static int beatClocks(MidiLooperAlgorithm* alg, int track) {
+    TrackState* ts = &alg->trackStates[track];
+    int loopLen;
+    int quantize = getCachedQuantize(alg->v, track, &ts->cache, loopLen);
+    return (quantize > 0 ? quantize : 1) * TrackParams::fromAlgorithm(alg->v, track).clockDiv();
+}
+
+static int recTrack(MidiLooperAlgorithm* alg) {
+    return clampParam(alg->v[kParamRecTrack], 0, alg->numTracks - 1);
+}
+
+// ============================================================================
+// CLICK OUTPUT
+// ============================================================================
+
+// Only called while a click note is sounding (metroNoteTime > 0)
+static void sendClickNoteOff(MidiLooper_DTC* dtc) {
+    NT_sendMidi3ByteMessage(dtc->metroWhere, withChannel(kMidiNoteOff, dtc->metroChannel), dtc->metroNote, 0);
+    dtc->metroNoteTime = 0.0f;
+}
+
+static void click(MidiLooperAlgorithm* alg, bool accent, int frameOffset) {
+    MidiLooper_DTC* dtc = alg->dtc;
+
+    // CV trigger, at most half a clock long so consecutive clicks stay separate
+    if (alg->v[kParamMetroOutput] > 0) {
+        float seconds = METRO_PULSE_SECONDS;
+        if (dtc->stepDuration * 0.5f < seconds) seconds = dtc->stepDuration * 0.5f;
+        dtc->metroPulseStart = frameOffset;
+        dtc->metroPulseFrames = (int)(seconds * (float)NT_globals.sampleRate) + 1;
+        dtc->metroPulseLevel = accent ? METRO_LEVEL_ACCENT : METRO_LEVEL_BEAT;
+    }
+
+    // MIDI note (sent when the block is processed, so only block-accurate)
+    int channel = dtc->settings[kSetMetroChannel];
+    if (channel > 0) {
+        if (dtc->metroNoteTime > 0.0f) sendClickNoteOff(dtc);
+        dtc->metroNote = (uint8_t)dtc->settings[kSetMetroNote];
+        dtc->metroChannel = (uint8_t)channel;
+        dtc->metroWhere = destToWhere(TrackParams::fromAlgorithm(alg->v, recTrack(alg)).destination());
+        NT_sendMidi3ByteMessage(dtc->metroWhere, withChannel(kMidiNoteOn, channel), dtc->metroNote,
+                                accent ? METRO_VEL_ACCENT : METRO_VEL_BEAT);
+        dtc->metroNoteTime = METRO_NOTE_SECONDS;
+    }
+}
+
+// Write the CV click into the output bus and time out the MIDI click
+void renderMetronome(MidiLooperAlgorithm* alg, float* busFrames, int numFrames, float dt) {
+    MidiLooper_DTC* dtc = alg->dtc;
+
+    int bus = alg->v[kParamMetroOutput];
+    if (bus > 0) {
+        float* out = busFrames + (bus - 1) * numFrames;
+        int start = (dtc->metroPulseFrames > 0) ? dtc->metroPulseStart : numFrames;
+        int end = start + dtc->metroPulseFrames;
+        if (end > numFrames) end = numFrames;
+        for (int i = 0; i < numFrames; i++) {
+            out[i] = (i >= start && i < end) ? dtc->metroPulseLevel : 0.0f;
+        }
+        if (end > start) dtc->metroPulseFrames -= end - start;
+        dtc->metroPulseStart = 0;
+    }
+
+    if (dtc->metroNoteTime > 0.0f) {
+        dtc->metroNoteTime -= dt;
+        if (dtc->metroNoteTime <= 0.0f) sendClickNoteOff(dtc);
+    }
+}
+
+void stopMetronome(MidiLooperAlgorithm* alg) {
+    alg->dtc->metroPulseFrames = 0;
+    if (alg->dtc->metroNoteTime > 0.0f) sendClickNoteOff(alg->dtc);
+}
+
+// Beat clicks while the loop runs (called after the tracks have processed a clock)
+void metronomeClock(MidiLooperAlgorithm* alg, int frameOffset) {
+    MidiLooper_DTC* dtc = alg->dtc;
+    int mode = dtc->settings[kSetMetronome];
+    if (mode == METRO_ON || (mode == METRO_RECORD && dtc->recordState == REC_LIVE)) {
+        int track = recTrack(alg);
+        TrackState* ts = &alg->trackStates[track];
+        if (!ts->ticked || ts->clockCount == 0) return;
+
+        int loopLen;
+        int quantize = getCachedQuantize(alg->v, track, &ts->cache, loopLen);
+        if (quantize < 1) quantize = 1;
+        uint32_t pos = ts->clockCount - 1;
+        if (pos % (uint32_t)quantize == 0) {
+            click(alg, (pos / (uint32_t)quantize) % BEATS_PER_BAR == 0, frameOffset);
+        }
+    }
+}
+
+// ============================================================================
+// SPANS
+// ============================================================================
+
+// Called after a clock has been processed; the next Rec Track step starts a new
+// beat, bar or loop when this returns true
+bool recTrackSpanEnded(MidiLooperAlgorithm* alg, int span) {
+    int track = recTrack(alg);
+    TrackState* ts = &alg->trackStates[track];
+    if (!ts->ticked) return false;
+
+    int loopLen;
+    int quantize = getCachedQuantize(alg->v, track, &ts->cache, loopLen);
+    if (quantize < 1) quantize = 1;
+
+    int steps = quantize;
+    if (span == SPAN_BAR) steps = quantize * BEATS_PER_BAR;
+    if (span == SPAN_LOOP) steps = loopLen;
+    return ts->clockCount % steps == 0;
+}
+
+// ============================================================================
+// COUNT-IN
+// ============================================================================
+
+// Enter REC_COUNT_IN on transport start if a count-in is set
+bool startCountIn(MidiLooperAlgorithm* alg) {
+    MidiLooper_DTC* dtc = alg->dtc;
+    int bars = dtc->settings[kSetCountIn];
+    if (bars <= 0) return false;
+
+    // Replace clears now, before count-in notes can land on step 1
+    int track = recTrack(alg);
+    if (alg->v[kParamRecMode] == REC_MODE_REPLACE) {
+        clearTrackEvents(&alg->trackStates[track]);
+    }
+    dtc->countInRemaining = (uint16_t)(bars * BEATS_PER_BAR * beatClocks(alg, track));
+    dtc->countInElapsed = 0;
+    dtc->recordState = REC_COUNT_IN;
+    return true;
+}
+
+// Consume a clock edge during count-in. Returns false once the count-in is over:
+// that clock is the downbeat and plays step 1 with recording live.
+bool advanceCountIn(MidiLooperAlgorithm* alg, int frameOffset) {
+    MidiLooper_DTC* dtc = alg->dtc;
+    if (dtc->recordState != REC_COUNT_IN) return false;
+
+    if (dtc->countInRemaining == 0) {
+        dtc->recordState = REC_LIVE;
+        return false;
+    }
+
+    int clocks = beatClocks(alg, recTrack(alg));
+    if (dtc->settings[kSetMetronome] != METRO_OFF && dtc->countInElapsed % clocks == 0) {
+        click(alg, (dtc->countInElapsed / clocks) % BEATS_PER_BAR == 0, frameOffset);
+    }
+    dtc->countInElapsed++;
+    dtc->countInRemaining--;
+    return true;
+}
+
+// Notes played during count-in: those that snap onto the downbeat (under the
+// usual Rec Division / Rec Snap rules, as if the count-in were the end of the
+// loop) are recorded on step 1; earlier ones are ignored.
+void countInNote(MidiLooperAlgorithm* alg, int track, uint8_t note, uint8_t velocity) {
+    MidiLooper_DTC* dtc = alg->dtc;
+    TrackState* ts = &alg->trackStates[track];
+    if (velocity == 0) {
+        if (findHeldNote(alg, note)) {
+            recordNoteOff(alg, createRecordingContext(alg->v, track, 1, 0.0f, 1.0f, &ts->cache), note);
+        }
+        return;
+    }
+
+    int clockDiv = TrackParams::fromAlgorithm(alg->v, track).clockDiv();
+    int stepsLeft = (dtc->countInRemaining + clockDiv) / clockDiv;
+    RecordingContext ctx = createRecordingContext(alg->v, track, 1, dtc->stepTime, dtc->stepDuration, &ts->cache);
+    if (stepsLeft > ctx.loopLen) return;
+    ctx.rawStep = ctx.loopLen - stepsLeft + 1;
+
+    recordNoteOn(alg, ctx, note, velocity);
+    HeldNote* held = findHeldNote(alg, note);
+    if (!held) return;
+    if (held->quantizedStep != 1) {
+        held->active = false;
+        return;
+    }
+    held->effectiveStep = 1;
+}
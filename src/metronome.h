@@ -0,0 +1,21 @@
+/*
+ * MIDI Looper - Count-In and Metronome
+ * Count-in before live recording, and click output as MIDI and/or CV trigger
+ */
+
+#pragma once
+
+#include "types.h"
+
+// Count-in (called from the transport and clock handling)
+bool startCountIn(MidiLooperAlgorithm* alg);
+bool advanceCountIn(MidiLooperAlgorithm* alg, int frameOffset);
+void countInNote(MidiLooperAlgorithm* alg, int track, uint8_t note, uint8_t velocity);
+
+// Quantized changes: true right after the Rec Track's clock that ends a SPAN_*
+bool recTrackSpanEnded(MidiLooperAlgorithm* alg, int span);
+
+// Clicks
+void metronomeClock(MidiLooperAlgorithm* alg, int frameOffset);
+void renderMetronome(MidiLooperAlgorithm* alg, float* busFrames, int numFrames, float dt);
+void stopMetronome(MidiLooperAlgorithm* alg);
@@ -1,4 +1,5 @@
 #include "midi.h"
+#include "launch.h"
 #include "midi_utils.h"
 
 // ============================================================================
@@ -30,7 +31,7 @@ void sendTrackNotesOff(MidiLooperAlgorithm* alg, int track) {
     ts->activeVel = 0;
 
     // Cancel any pending delayed notes for this track
-    for (int i = 0; i < MAX_DELAYED_NOTES; i++) {
+    for (int i = 0; i < alg->numDelayedNotes; i++) {
         if (alg->delayedNotes[i].active && alg->delayedNotes[i].track == (uint8_t)track) {
             alg->delayedNotes[i].active = false;
         }
@@ -48,14 +49,70 @@ bool isNoteSharedByOtherTrack(MidiLooperAlgorithm* alg, int track, uint8_t note,
     return false;
 }
 
+// ============================================================================
+// PROGRAM CHANGE
+// ============================================================================
+
+// Send a Bank (CC 0/32) and Program on the track's output channel. Nothing is
+// sent while Program is 0.
+void sendProgram(MidiLooperAlgorithm* alg, int track, int program, int bank) {
+    if (program == 0) return;
+
+    TrackParams tp = TrackParams::fromAlgorithm(alg->v, track);
+    int ch = tp.channel();
+    uint32_t where = destToWhere(tp.destination());
+
+    if (bank > 0) {
+        NT_sendMidi3ByteMessage(where, withChannel(kMidiCC, ch), 0, (uint8_t)(((bank - 1) >> 7) & 0x7F));
+        NT_sendMidi3ByteMessage(where, withChannel(kMidiCC, ch), 32, (uint8_t)((bank - 1) & 0x7F));
+    }
+    NT_sendMidi2ByteMessage(where, withChannel(kMidiProgramChange, ch), (uint8_t)(program - 1));
+}
+
+// Keep each track's synth on the patch it needs (called from step() before
+// the clocks): the playing slot's, or a pending launch's once the switch is
+// within PC Lead. Only changes are sent; a preset load or a stop (see
+// handleTransportStop) asks for everything to be sent again.
+void processProgramChanges(MidiLooperAlgorithm* alg) {
+    MidiLooper_DTC* dtc = alg->dtc;
+    bool resend = dtc->programsPending;
+    dtc->programsPending = false;
+    bool running = transportIsRunning(dtc->transportState);
+    float lead = (float)dtc->settings[kSetProgLead] * 0.001f;
+
+    for (int t = 0; t < alg->numTracks; t++) {
+        TrackState* ts = &alg->trackStates[t];
+        int program = ts->settings[kTrkSetProgram];
+        int bank = ts->settings[kTrkSetBank];
+        int slot = ts->launchSlot;
+        if (running && slot != LAUNCH_NONE && launchTimeLeft(alg, t) <= lead) {
+            program = ts->slotProgram[slot];
+            bank = ts->slotBank[slot];
+        }
+        if (!resend && program == ts->sentProgram && bank == ts->sentBank) continue;
+
+        sendProgram(alg, t, program, bank);
+        ts->sentProgram = (int16_t)program;
+        ts->sentBank = (int16_t)bank;
+    }
+}
+
 // ============================================================================
 // TRACK EVENT HELPERS
 // ============================================================================
 
-void clearTrackEvents(TrackData* track) {
+void clearTrackEvents(TrackState* ts) {
     for (int s = 0; s < MAX_STEPS; s++) {
-        track->steps[s].count = 0;
+        ts->data->steps[s].count = 0;
     }
+    markTrackEdited(ts);
+}
+
+// Invalidate data derived from the track's events after a bulk edit.
+// Single recorded events update the derived data incrementally instead.
+void markTrackEdited(TrackState* ts) {
+    ts->histDirty = true;
+    ts->ranksDirty = true;
 }
 
 bool hasNoteEvent(const StepEvents* evs, uint8_t noteNum) {
@@ -65,11 +122,14 @@ bool hasNoteEvent(const StepEvents* evs, uint8_t noteNum) {
     return false;
 }
 
-void addEvent(StepEvents* evs, uint8_t note, uint8_t velocity, uint16_t duration) {
+// Returns true if the event was stored (false if the step is full or has the note)
+bool addEvent(StepEvents* evs, uint8_t note, uint8_t velocity, uint16_t duration) {
     if (evs->count < MAX_EVENTS_PER_STEP && !hasNoteEvent(evs, note)) {
         evs->events[evs->count].note = note;
         evs->events[evs->count].velocity = velocity;
         evs->events[evs->count].duration = duration;
         evs->count++;
+        return true;
     }
+    return false;
 }
@@ -12,7 +12,12 @@ void sendAllNotesOff(MidiLooperAlgorithm* alg);
 void sendTrackNotesOff(MidiLooperAlgorithm* alg, int track);
 bool isNoteSharedByOtherTrack(MidiLooperAlgorithm* alg, int track, uint8_t note, uint8_t outCh, uint32_t where);
 
+// Program change: sent ahead of the track's next notes by PC Lead
+void sendProgram(MidiLooperAlgorithm* alg, int track, int program, int bank);
+void processProgramChanges(MidiLooperAlgorithm* alg);
+
 // Track event helpers
-void clearTrackEvents(TrackData* track);
+void clearTrackEvents(TrackState* ts);
+void markTrackEdited(TrackState* ts);
 bool hasNoteEvent(const StepEvents* evs, uint8_t noteNum);
-void addEvent(StepEvents* evs, uint8_t note, uint8_t velocity, uint16_t duration);
+bool addEvent(StepEvents* evs, uint8_t note, uint8_t velocity, uint16_t duration);
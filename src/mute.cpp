@@ -0,0 +1,59 @@
+/*
+ * MIDI Looper - Mute and Solo
+ *
+ * The Mute and Solo settings hold the requested masks; they take effect
+ * together (immediately, or on the clock that starts the Rec Track's next
+ * beat, bar or loop) by recomputing a single audible mask. Playback then
+ * tests one bit per track. Tracks that fall silent have their sounding notes
+ * cut unless Mute Ring is set.
+ */
+
+#include "mute.h"
+#include "metronome.h"
+#include "midi.h"
+
+static void applyMuteChange(MidiLooperAlgorithm* alg) {
+    MidiLooper_DTC* dtc = alg->dtc;
+    dtc->muteMask = (uint8_t)dtc->settings[kSetMute];
+    dtc->soloMask = (uint8_t)dtc->settings[kSetSolo];
+    dtc->muteDue = false;
+
+    uint8_t audible = dtc->soloMask ? dtc->soloMask : (uint8_t)~dtc->muteMask;
+    uint8_t silenced = dtc->audibleMask & ~audible;
+    dtc->audibleMask = audible;
+
+    if (silenced && !dtc->settings[kSetMuteRing]) {
+        for (int t = 0; t < alg->numTracks; t++) {
+            if ((silenced >> t) & 1) sendTrackNotesOff(alg, t);
+        }
+    }
+}
+
+// True while the Mute/Solo settings differ from the applied masks. A change
+// reverted before its boundary is no longer pending, so its boundary is dropped.
+static bool muteChangePending(MidiLooper_DTC* dtc) {
+    if (dtc->settings[kSetMute] != dtc->muteMask || dtc->settings[kSetSolo] != dtc->soloMask) return true;
+    dtc->muteDue = false;
+    return false;
+}
+
+void processMuteChange(MidiLooperAlgorithm* alg, bool clockEdge) {
+    MidiLooper_DTC* dtc = alg->dtc;
+    if (!muteChangePending(dtc)) return;
+
+    bool now = dtc->settings[kSetMuteQuant] == MUTE_QUANT_NOW || !transportIsRunning(dtc->transportState);
+    if (now || (clockEdge && dtc->muteDue)) {
+        applyMuteChange(alg);
+    }
+}
+
+// After a clock: note when the Rec Track has just finished a beat, bar or loop
+void muteClockProcessed(MidiLooperAlgorithm* alg) {
+    MidiLooper_DTC* dtc = alg->dtc;
+    if (!muteChangePending(dtc)) return;
+
+    int quant = dtc->settings[kSetMuteQuant];
+    if (quant != MUTE_QUANT_NOW && recTrackSpanEnded(alg, quant)) {
+        dtc->muteDue = true;
+    }
+}
@@ -0,0 +1,17 @@
+/*
+ * MIDI Looper - Mute and Solo
+ * Track mute/solo bitmasks with quantized changes
+ */
+
+#pragma once
+
+#include "types.h"
+
+// Quantized apply (called from step())
+void processMuteChange(MidiLooperAlgorithm* alg, bool clockEdge);
+void muteClockProcessed(MidiLooperAlgorithm* alg);
+
+// Tracks allowed to emit notes
+static inline bool trackAudible(const MidiLooper_DTC* dtc, int track) {
+    return (dtc->audibleMask >> track) & 1;
+}
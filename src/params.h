@@ -6,6 +6,7 @@
 #pragma once
 
 #include "config.h"
+#include "scales.h"
 #include "types.h"
 #include <cstddef> // for NULL
 
@@ -19,13 +20,30 @@ static const char* const recModeStrings[] = {"Replace", "Overdub", "Step", NULL}
 static const char* const midiDestStrings[] = {"Breakout", "SelectBus", "USB", "Internal", "All", NULL};
 static const char* const noYesStrings[] = {"No", "Yes", NULL};
 static const char* const divisionStrings[] = {"1", "2", "4", "8", "16", NULL};
+static const char* const beatRepeatStrings[] = {"Off", "1/2", "1/4", "1/8", NULL};
 static const char* const directionStrings[] = {"Forward",  "Reverse",  "Pendulum", "Ping-Pong", "Odd/Even", "Hopscotch",
                                                "Converge", "Diverge",  "Brownian", "Random",    "Shuffle",
                                                "Stride 2", "Stride 3", "Stride 4", "Stride 5",  NULL};
 static const char* const scaleRootStrings[] = {"C", "C#", "D", "Eb", "E", "F", "F#", "G", "Ab", "A", "Bb", "B", NULL};
 static const char* const scaleTypeStrings[] = {"Off",     "Ionian",   "Dorian",   "Phrygian",  "Lydian",    "Mixolydian", "Aeolian",
-                                               "Locrian", "Harm Min", "Melo Min", "Maj Penta", "Min Penta", NULL};
-static const char* const genModeStrings[] = {"New", "Reorder", "Re-pitch", "Invert", NULL};
+                                               "Locrian", "Harm Min", "Melo Min", "Maj Penta", "Min Penta",  "User 1",
+                                               "User 2",  "User 3",   "User 4",   "Note Map",  NULL};
+static const char* const genModeStrings[] = {"New", "Reorder", "Re-pitch", "Invert", "Chord", "Chord VL", NULL};
+static const char* const actionStrings[] = {"Copy",       "Paste",      "Duplicate",  "Double",    "Copy Track",
+                                            "Detect Key", "Apply Key",  "Capture 1",  "Capture 2", "Capture 4",
+                                            "Freeze",     "Store Scn",  "Recall Scn", "Skip",      "Unskip",
+                                            NULL};
+// Setting names (global kSet* entries first, then per-track kTrkSet* entries)
+static const char* const settingStrings[] = {"Rng Start",  "Rng End",    "Dest Track", "Dest Step",  "Edit Quant",
+                                             "User Scl 1", "User Scl 2", "User Scl 3", "User Scl 4", "Count-In",
+                                             "Metronome",  "Metro Ch",   "Metro Note", "Frz Loops",  "Scene",
+                                             "Scene Qnt",  "Mute",       "Solo",       "Mute Qnt",   "Mute Ring",
+                                             "CC Learn",   "Lnch Ch",    "Lnch Note",  "Lnch Qnt",   "PC Lead",
+                                             "CV Vel",     "Resume",
+                                             "Follow",     "Follow Ofs", "Legato",     "Loop Start", "Repeat",
+                                             "Dep Track",  "Dep Mode",   "Mod Type",   "Mod Dest",   "Mod Amount",
+                                             "Program",    "Bank",
+                                             NULL};
 // clang-format off
 static const char* const trigCondStrings[] = {
     "Always",
@@ -99,13 +117,13 @@ static const _NT_parameter parameters[] = {
     {.name = "MIDI In Ch", .min = 0, .max = 16, .def = 1, .unit = kNT_unitNone, .scaling = 0, .enumStrings = NULL},
     {.name = "Panic On Wrap", .min = 0, .max = 1, .def = 0, .unit = kNT_unitEnum, .scaling = 0, .enumStrings = noYesStrings},
     {.name = "Scale Root", .min = 0, .max = 11, .def = 0, .unit = kNT_unitEnum, .scaling = 0, .enumStrings = scaleRootStrings},
-    {.name = "Scale", .min = 0, .max = 11, .def = 0, .unit = kNT_unitEnum, .scaling = 0, .enumStrings = scaleTypeStrings},
+    {.name = "Scale", .min = 0, .max = SCALE_COUNT - 1, .def = 0, .unit = kNT_unitEnum, .scaling = 0, .enumStrings = scaleTypeStrings},
     {.name = "Clear Track", .min = 0, .max = 1, .def = 0, .unit = kNT_unitEnum, .scaling = 0, .enumStrings = noYesStrings},
     {.name = "Clear All", .min = 0, .max = 1, .def = 0, .unit = kNT_unitEnum, .scaling = 0, .enumStrings = noYesStrings},
 
     // Generate parameters (12-19)
     {.name = "Generate", .min = 0, .max = 1, .def = 0, .unit = kNT_unitEnum, .scaling = 0, .enumStrings = noYesStrings},
-    {.name = "Gen Mode", .min = 0, .max = 3, .def = 0, .unit = kNT_unitEnum, .scaling = 0, .enumStrings = genModeStrings},
+    {.name = "Gen Mode", .min = 0, .max = 5, .def = 0, .unit = kNT_unitEnum, .scaling = 0, .enumStrings = genModeStrings},
     {.name = "Density", .min = 1, .max = 100, .def = 50, .unit = kNT_unitPercent, .scaling = 0, .enumStrings = NULL},
     {.name = "Bias", .min = 0, .max = 127, .def = 60, .unit = kNT_unitMIDINote, .scaling = 0, .enumStrings = NULL},
     {.name = "Range", .min = 0, .max = 48, .def = 12, .unit = kNT_unitNone, .scaling = 0, .enumStrings = NULL},
@@ -115,6 +133,28 @@ static const _NT_parameter parameters[] = {
     {.name = "Gate Rand", .min = 0, .max = 100, .def = 0, .unit = kNT_unitPercent, .scaling = 0, .enumStrings = NULL},
     {.name = "Fill", .min = 0, .max = 1, .def = 0, .unit = kNT_unitEnum, .scaling = 0, .enumStrings = noYesStrings},
 
+    // Edit parameters (23-26)
+    {.name = "Action", .min = 0, .max = 14, .def = 0, .unit = kNT_unitEnum, .scaling = 0, .enumStrings = actionStrings},
+    {.name = "Execute", .min = 0, .max = 1, .def = 0, .unit = kNT_unitEnum, .scaling = 0, .enumStrings = noYesStrings},
+    {.name = "Setting", .min = 0, .max = TOTAL_SETTINGS - 1, .def = 0, .unit = kNT_unitEnum, .scaling = 0, .enumStrings = settingStrings},
+    {.name = "Value", .min = -128, .max = 4095, .def = 1, .unit = kNT_unitNone, .scaling = 0, .enumStrings = NULL},
+
+    // Metronome output (27)
+    NT_PARAMETER_CV_OUTPUT("Metro Out", 0, 0) // 0 = none
+
+    // Overdub feedback (28)
+    {.name = "Feedback", .min = 0, .max = 100, .def = 100, .unit = kNT_unitPercent, .scaling = 0, .enumStrings = NULL},
+
+    // Beat repeat (29)
+    {.name = "Beat Repeat", .min = 0, .max = 3, .def = 0, .unit = kNT_unitEnum, .scaling = 0, .enumStrings = beatRepeatStrings},
+
+    // Density macro (30)
+    {.name = "Play Density", .min = 0, .max = 100, .def = 100, .unit = kNT_unitPercent, .scaling = 0, .enumStrings = NULL},
+
+    // CV note input (31-32)
+    NT_PARAMETER_CV_INPUT("Pitch In", 0, 0) // 0 = none
+    NT_PARAMETER_CV_INPUT("Gate In", 0, 0)  // 0 = none (CV recording off)
+
     // Track parameters - PARAMS_PER_TRACK per track
     TRACK_PARAMS(1, 2) // Track 1: enabled by default, channel 2
     TRACK_PARAMS(0, 3) // Track 2: disabled by default, channel 3
@@ -132,11 +172,11 @@ static const _NT_parameter parameters[] = {
 // PARAMETER PAGES
 // ============================================================================
 
-// Page 0: Routing (Input bus selection)
-static const uint8_t pageRouting[] = {kParamRunInput, kParamClockInput};
+// Page 0: Routing (Input/output bus selection)
+static const uint8_t pageRouting[] = {kParamRunInput, kParamClockInput, kParamMetroOutput, kParamPitchInput, kParamCvGateInput};
 
 // Page 1: Global (Recording)
-static const uint8_t pageGlobal[] = {kParamRecord, kParamRecTrack, kParamRecDivision, kParamRecMode, kParamRecSnap, kParamClearTrack, kParamClearAll, kParamFill};
+static const uint8_t pageGlobal[] = {kParamRecord, kParamRecTrack, kParamRecDivision, kParamRecMode, kParamRecSnap, kParamFeedback, kParamClearTrack, kParamClearAll, kParamFill, kParamBeatRepeat, kParamPlayDensity};
 
 // Page 2: MIDI Config
 static const uint8_t pageMidiConfig[] = {kParamMidiInCh, kParamPanicOnWrap, kParamScaleRoot, kParamScaleType};
@@ -146,6 +186,9 @@ static const uint8_t pageGenerate[] = {kParamGenerate,    kParamGenMode,     kPa
                                        kParamGenRange,    kParamGenNoteRand, kParamGenVelVar,  kParamGenTies,
                                        kParamGenGateRand};
 
+// Page 4: Edit
+static const uint8_t pageEdit[] = {kParamAction, kParamExecute, kParamSetting, kParamSettingValue};
+
 // ============================================================================
 // DYNAMIC PAGE BUILDING (for specification-based track count)
 // ============================================================================
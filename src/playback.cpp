@@ -3,10 +3,17 @@
 #include "midi.h"
 #include "midi_utils.h"
 #include "directions.h"
+#include "capture.h"
+#include "edit.h"
+#include "launch.h"
+#include "metronome.h"
 #include "modifiers.h"
+#include "mute.h"
+#include "quantize.h"
 #include "recording.h"
 #include "random.h"
 #include "scales.h"
+#include "serial.h"
 
 // ============================================================================
 // TRIG CONDITION EVALUATION
@@ -60,17 +67,124 @@ static bool evaluateTrigCondition(int cond, uint16_t loopCount, bool fillActive)
     }
 }
 
+// ============================================================================
+// TRACK ORDER
+// ============================================================================
+
+static int8_t resolveTrackRef(int setting, int track, int numTracks) {
+    int ref = setting - 1;
+    return (int8_t)((ref >= 0 && ref < numTracks && ref != track) ? ref : -1);
+}
+
+// First reference of an unplaced track that is itself still unplaced
+static int unplacedRef(const TrackState* ts, uint8_t modSources, uint8_t placed) {
+    if (ts->leader >= 0 && !((placed >> ts->leader) & 1)) return ts->leader;
+    if (ts->depTrack >= 0 && !((placed >> ts->depTrack) & 1)) return ts->depTrack;
+    uint8_t waiting = modSources & ~placed;
+    for (int m = 0; m < MAX_TRACKS; m++) {
+        if ((waiting >> m) & 1) return m;
+    }
+    return -1;
+}
+
+// Find a cycle among the unplaced tracks (every one of them waits on another,
+// so following those references must come back round) and drop the references
+// its members make to each other
+static void breakCycle(MidiLooperAlgorithm* alg, uint8_t* modSources, uint8_t placed) {
+    int8_t visitedAt[MAX_TRACKS];
+    int8_t path[MAX_TRACKS];
+    for (int i = 0; i < MAX_TRACKS; i++) visitedAt[i] = -1;
+
+    int t = 0;
+    while ((placed >> t) & 1) t++;
+    int len = 0;
+    while (visitedAt[t] < 0) {
+        visitedAt[t] = (int8_t)len;
+        path[len++] = (int8_t)t;
+        t = unplacedRef(&alg->trackStates[t], modSources[t], placed);
+    }
+
+    uint8_t cycle = 0;
+    for (int i = visitedAt[t]; i < len; i++) cycle |= (uint8_t)(1u << path[i]);
+    for (int c = 0; c < MAX_TRACKS; c++) {
+        if (!((cycle >> c) & 1)) continue;
+        TrackState* ts = &alg->trackStates[c];
+        if (ts->leader >= 0 && ((cycle >> ts->leader) & 1)) ts->leader = -1;
+        if (ts->depTrack >= 0 && ((cycle >> ts->depTrack) & 1)) ts->depTrack = -1;
+        uint8_t sources = modSources[c] & cycle;
+        modSources[c] &= (uint8_t)~cycle;
+        for (int m = 0; m < MAX_TRACKS; m++) {
+            if ((sources >> m) & 1) alg->trackStates[m].modDest &= (uint8_t)~(1u << c);
+        }
+    }
+}
+
+// Resolve Follow, Dep Track and Mod Dest settings into a clock processing
+// order (a topological sort) in which every leader, dependency and modulator
+// comes before the tracks that read its result. References that point at a
+// missing track are ignored, and so are those between the members of a cycle
+// (the tracks waiting on a cycle keep theirs).
+void buildTrackOrder(MidiLooperAlgorithm* alg) {
+    int numTracks = alg->numTracks;
+    uint8_t modSources[MAX_TRACKS] = {};
+    uint8_t placed = 0;
+    int count = 0;
+
+    for (int t = 0; t < numTracks; t++) {
+        TrackState* ts = &alg->trackStates[t];
+        ts->leader = resolveTrackRef(ts->settings[kTrkSetFollow], t, numTracks);
+        ts->depTrack = resolveTrackRef(ts->settings[kTrkSetDepTrack], t, numTracks);
+        ts->modulates = ts->settings[kTrkSetModType] != MOD_OFF;
+        ts->modDest = 0;
+        if (!ts->modulates) continue;
+        for (int d = 0; d < numTracks; d++) {
+            if (d != t && ((ts->settings[kTrkSetModDest] >> d) & 1)) {
+                ts->modDest |= (uint8_t)(1u << d);
+                modSources[d] |= (uint8_t)(1u << t);
+            }
+        }
+    }
+
+    // Place tracks whose references are already placed until nothing changes,
+    // then break a cycle holding the rest up and carry on
+    while (count < numTracks) {
+        bool progress = false;
+        for (int t = 0; t < numTracks; t++) {
+            const TrackState* ts = &alg->trackStates[t];
+            if (((placed >> t) & 1) || unplacedRef(ts, modSources[t], placed) >= 0) continue;
+            placed |= (uint8_t)(1u << t);
+            alg->trackOrder[count++] = (uint8_t)t;
+            progress = true;
+        }
+        if (!progress) breakCycle(alg, modSources, placed);
+    }
+}
+
 // ============================================================================
 // TRANSPORT CONTROL
 // ============================================================================
 
-// Reset all tracks and start transport
+// Reset all tracks and start transport. After a preset load with Resume on,
+// tracks take the loaded playback state instead: deterministic directions
+// place each clock from clockCount alone, so they pick up exactly where they
+// were without replaying the run, and Brownian/Shuffle carry their positions.
+// The clock count since start comes back with them, so capture and bar
+// positions line up with the resumed tracks.
 void handleTransportStart(MidiLooperAlgorithm* alg) {
     MidiLooper_DTC* dtc = alg->dtc;
+    bool resume = dtc->resumePending;
+    dtc->resumePending = false;
 
     for (int t = 0; t < alg->numTracks; t++) {
         TrackState* ts = &alg->trackStates[t];
+        ts->repeating = false;
+        ts->repeatValid = 1;
+        dtc->modTranspose[t] = 0;
+        ts->wrapped = false;
+        if (resume) continue; // applyLoadedPlayback below
+
         ts->step = 0;
+        ts->walkPos = 0;
         ts->clockCount = 0;
         ts->divCounter = 0;
         ts->loopCount = 0;
@@ -84,13 +198,17 @@ void handleTransportStart(MidiLooperAlgorithm* alg) {
         }
     }
     dtc->stepTime = 0.0f;
+    dtc->clockTicks = 0;
+    if (resume) applyLoadedPlayback(alg);
+    resetCaptureHistory(alg);
     dtc->transportState = transportTransition_Start(dtc->transportState);
 
     // Promote pending live recording now that transport is running
-    if (dtc->recordState == REC_LIVE_PENDING) {
+    // (after the count-in, if one is set)
+    if (dtc->recordState == REC_LIVE_PENDING && !startCountIn(alg)) {
         int recTrack = clampParam(alg->v[kParamRecTrack], 0, alg->numTracks - 1);
         if (alg->v[kParamRecMode] == REC_MODE_REPLACE) {
-            clearTrackEvents(&alg->trackStates[recTrack].data);
+            clearTrackEvents(&alg->trackStates[recTrack]);
         }
         dtc->recordState = REC_LIVE;
     }
@@ -104,10 +222,20 @@ void handleTransportStop(MidiLooperAlgorithm* alg) {
     if (dtc->recordState == REC_LIVE) {
         finalizeHeldNotes(alg);
         dtc->recordState = REC_IDLE;
+    } else if (dtc->recordState == REC_COUNT_IN) {
+        // Record is still on: count in again on the next start
+        clearHeldNotes(alg);
+        dtc->recordState = REC_LIVE_PENDING;
     }
+    stopMetronome(alg);
 
     dtc->transportState = transportTransition_Stop(dtc->transportState);
 
+    // Deferred edits would never see their wrap now, so apply them immediately
+    for (int t = 0; t < alg->numTracks; t++) {
+        applyPendingEdits(alg, t);
+    }
+
     // Send precise note-offs using stored per-note channel/dest,
     // then CC 123 on current channels as a safety net
     for (int t = 0; t < alg->numTracks; t++) {
@@ -118,6 +246,7 @@ void handleTransportStop(MidiLooperAlgorithm* alg) {
     for (int t = 0; t < alg->numTracks; t++) {
         TrackState* ts = &alg->trackStates[t];
         ts->step = 0;
+        ts->walkPos = 0;
         ts->clockCount = 0;
         ts->divCounter = 0;
         ts->loopCount = 0;
@@ -127,6 +256,23 @@ void handleTransportStop(MidiLooperAlgorithm* alg) {
     }
 
     dtc->stepTime = 0.0f;
+    dtc->clockTicks = 0; // A save while stopped resumes from the top, like the tracks
+
+    // Send every track's patch again now, so the next start has it in place
+    // before its first note
+    dtc->programsPending = true;
+}
+
+// ============================================================================
+// LEGATO
+// ============================================================================
+
+// A note already sounding on the same channel/destination is extended rather
+// than retriggered (no new note-on). Returns true if the note was extended.
+static bool extendPlayingNote(PlayingNote* pn, uint8_t outCh, uint32_t where, uint16_t duration) {
+    if (!pn->active || pn->outCh != outCh || pn->where != where) return false;
+    if (duration > pn->remaining) pn->remaining = duration;
+    return true;
 }
 
 // ============================================================================
@@ -138,7 +284,7 @@ void processDelayedNotes(MidiLooperAlgorithm* alg, float dt) {
     int delayDecrement = (int)(dt * 1000.0f);
     if (delayDecrement < 1) delayDecrement = 1;
 
-    for (int i = 0; i < MAX_DELAYED_NOTES; i++) {
+    for (int i = 0; i < alg->numDelayedNotes; i++) {
         DelayedNote* dn = &alg->delayedNotes[i];
         if (!dn->active) continue;
 
@@ -147,9 +293,14 @@ void processDelayedNotes(MidiLooperAlgorithm* alg, float dt) {
             int track = safeTrackIndex(dn->track);
             int note = safeNoteIndex(dn->note);
             TrackState* ts = &alg->trackStates[track];
+            PlayingNote* existing = &ts->playing[note];
+
+            if (ts->settings[kTrkSetLegato] && extendPlayingNote(existing, dn->outCh, dn->where, dn->duration)) {
+                dn->active = false;
+                continue;
+            }
 
             // If re-triggering on a different channel/dest, release the old note first
-            PlayingNote* existing = &ts->playing[note];
             if (existing->active && (existing->outCh != dn->outCh || existing->where != dn->where)) {
                 if (!isNoteSharedByOtherTrack(alg, track, (uint8_t)note, existing->outCh, existing->where)) {
                     NT_sendMidi3ByteMessage(existing->where, withChannel(kMidiNoteOff, existing->outCh), (uint8_t)note, 0);
@@ -176,7 +327,7 @@ void processDelayedNotes(MidiLooperAlgorithm* alg, float dt) {
 static bool scheduleDelayedNote(MidiLooperAlgorithm* alg, uint8_t note, uint8_t velocity,
                                  uint8_t track, uint8_t outCh, uint16_t duration,
                                  uint16_t delay, uint32_t where) {
-    for (int di = 0; di < MAX_DELAYED_NOTES; di++) {
+    for (int di = 0; di < alg->numDelayedNotes; di++) {
         if (!alg->delayedNotes[di].active) {
             alg->delayedNotes[di].active = true;
             alg->delayedNotes[di].note = note;
@@ -198,36 +349,96 @@ static bool scheduleDelayedNote(MidiLooperAlgorithm* alg, uint8_t note, uint8_t
 // NOTE DURATION PROCESSING
 // ============================================================================
 
-// Process note duration countdowns for a track
-static void processNoteDurations(MidiLooperAlgorithm* alg, int track) {
+// Send the note-off for a playing note and clear it
+static void releasePlayingNote(MidiLooperAlgorithm* alg, int track, int n) {
     TrackState* ts = &alg->trackStates[track];
+    PlayingNote* pn = &ts->playing[n];
+
+    if (!isNoteSharedByOtherTrack(alg, track, (uint8_t)n, pn->outCh, pn->where)) {
+        NT_sendMidi3ByteMessage(pn->where, withChannel(kMidiNoteOff, pn->outCh), (uint8_t)n, 0);
+    }
+    pn->active = false;
+    ts->activeNotes[n] = 0;
+
+    // Update activeVel if no more notes
+    bool hasActive = false;
+    for (int m = 0; m < 128; m++) {
+        if (ts->activeNotes[m] > 0) {
+            hasActive = true;
+            break;
+        }
+    }
+    if (!hasActive) {
+        ts->activeVel = 0;
+    }
+}
+
+// Process note duration countdowns for a track.
+// In legato mode, notes that run out are only marked (remaining = 0) and
+// released by releaseExpiredNotes() after the step's new notes have been sent,
+// so a new note-on precedes the old note-off. Returns the number marked.
+static int processNoteDurations(MidiLooperAlgorithm* alg, int track, bool legato) {
+    TrackState* ts = &alg->trackStates[track];
+    int expired = 0;
 
     for (int n = 0; n < 128; n++) {
         PlayingNote* pn = &ts->playing[n];
         if (!pn->active) continue;
 
         if (pn->remaining <= 1) {
-            if (!isNoteSharedByOtherTrack(alg, track, (uint8_t)n, pn->outCh, pn->where)) {
-                NT_sendMidi3ByteMessage(pn->where, withChannel(kMidiNoteOff, pn->outCh), (uint8_t)n, 0);
-            }
-            pn->active = false;
-            ts->activeNotes[n] = 0;
-
-            // Update activeVel if no more notes
-            bool hasActive = false;
-            for (int m = 0; m < 128; m++) {
-                if (ts->activeNotes[m] > 0) {
-                    hasActive = true;
-                    break;
-                }
-            }
-            if (!hasActive) {
-                ts->activeVel = 0;
+            if (legato) {
+                pn->remaining = 0;
+                expired++;
+            } else {
+                releasePlayingNote(alg, track, n);
             }
         } else {
             pn->remaining--;
         }
     }
+    return expired;
+}
+
+// Release legato notes that ran out and were not extended by the new step
+static void releaseExpiredNotes(MidiLooperAlgorithm* alg, int track) {
+    TrackState* ts = &alg->trackStates[track];
+    for (int n = 0; n < 128; n++) {
+        if (ts->playing[n].active && ts->playing[n].remaining == 0) {
+            releasePlayingNote(alg, track, n);
+        }
+    }
+}
+
+// ============================================================================
+// LOOP WINDOW
+// ============================================================================
+
+// Directions and modifiers walk positions 1..walkLen; stepMap turns each into
+// the step it plays: the Length steps from Loop Start (wrapping past step 128),
+// minus skipped steps. Moving the window or changing the skip mask only costs
+// a table rebuild on the track's next clock.
+static int refreshStepMap(TrackState* ts, int loopLen) {
+    int start = ts->settings[kTrkSetLoopStart];
+    if (!ts->stepMapDirty && ts->mapLength == loopLen && ts->mapStart == start) return ts->walkLen;
+
+    int prevCount = ts->walkLen;
+    int count = 0;
+    for (int pos = 1; pos <= loopLen; pos++) {
+        int step = windowStep(ts, pos);
+        if (!stepSkipped(ts, step - 1)) ts->stepMap[count++] = (uint8_t)step;
+    }
+    ts->walkLen = (uint8_t)count;
+    ts->mapLength = (uint8_t)loopLen;
+    ts->mapStart = (uint8_t)start;
+    ts->stepMapDirty = false;
+
+    // Walk state from a longer map restarts inside the new one
+    if (count < prevCount) {
+        if (ts->brownianPos > count) ts->brownianPos = 1;
+        if (ts->lastStep > count) ts->lastStep = 1;
+        ts->shufflePos = (uint8_t)(count + 1);
+    }
+    return count;
 }
 
 // ============================================================================
@@ -310,16 +521,24 @@ static void emitNote(MidiLooperAlgorithm* alg, int track, NoteEvent* ev,
                      int velOffset, int humanize, int outCh, uint32_t where,
                      int noteShift) {
     TrackState* ts = &alg->trackStates[track];
-    int actualNote = clamp((int)ev->note + noteShift, 0, 127);
-    int scaleRoot = alg->v[kParamScaleRoot];
-    int scaleType = alg->v[kParamScaleType];
-    actualNote = quantizeToScale((uint8_t)actualNote, scaleRoot, scaleType);
+    MidiLooper_DTC* dtc = alg->dtc;
+
+    // Cross-track modulation from this clock's modulator steps
+    if (dtc->modChance[track] < 100 && randFloat(ts->randState) * 100.0f >= (float)dtc->modChance[track]) return;
+    noteShift += dtc->modTranspose[track];
+    velOffset += dtc->modVelocity[track];
+
+    int actualNote = quantizeNote(alg, clamp((int)ev->note + noteShift, 0, 127));
     int velocity = clamp((int)ev->velocity + velOffset, 0, 127);
     int delay = (humanize > 0) ? randRange(ts->randState, 0, humanize) : 0;
 
     if (delay == 0) {
-        // If re-triggering on a different channel/dest, release the old note first
         PlayingNote* existing = &ts->playing[actualNote];
+        if (ts->settings[kTrkSetLegato] && extendPlayingNote(existing, (uint8_t)outCh, where, ev->duration)) {
+            return;
+        }
+
+        // If re-triggering on a different channel/dest, release the old note first
         if (existing->active && (existing->outCh != (uint8_t)outCh || existing->where != where)) {
             if (!isNoteSharedByOtherTrack(alg, track, (uint8_t)actualNote, existing->outCh, existing->where)) {
                 NT_sendMidi3ByteMessage(existing->where, withChannel(kMidiNoteOff, existing->outCh), (uint8_t)actualNote, 0);
@@ -345,16 +564,58 @@ static void playTrackEvents(MidiLooperAlgorithm* alg, int track, int finalStep,
     int stepIdx = finalStep - 1;
     if (stepIdx < 0 || stepIdx >= MAX_STEPS) return;
 
-    StepEvents* evs = &alg->trackStates[track].data.steps[stepIdx];
+    TrackState* ts = &alg->trackStates[track];
+    StepEvents* evs = &ts->data->steps[stepIdx];
     if (evs->count == 0) return;
 
     int noteShift = fixed ? 0 : calculateOctaveJump(alg, track, tp);
+    int density = alg->v[kParamPlayDensity];
 
     for (int e = 0; e < evs->count; e++) {
+        // Thinned by Play Density (at 100 everything plays, even before ranks are rebuilt)
+        if (density < 100 && ts->eventRank[stepIdx][e] >= density) continue;
         emitNote(alg, track, &evs->events[e], velOffset, humanize, outCh, where, noteShift);
     }
 }
 
+// ============================================================================
+// BEAT REPEAT
+// ============================================================================
+
+// While Beat Repeat is held, replay the steps of the last span clocks before it
+// engaged. The pipeline keeps running underneath, so on release playback is
+// where it would have been. Engaging and releasing only latch repeatStart.
+// clockCount wraps at 16 bits, so clock distances are taken modulo 2^16 (the
+// history length divides it, so ring indices stay in step across the wrap).
+static int applyBeatRepeat(MidiLooperAlgorithm* alg, TrackState* ts, int walkLen, int finalStep) {
+    int repeat = alg->v[kParamBeatRepeat];
+    uint16_t now = ts->clockCount;
+    if (repeat == 0 || !ts->settings[kTrkSetRepeat]) {
+        if (ts->repeating) {
+            ts->repeating = false;
+            ts->repeatValid = now; // Clocks during the repeat were not recorded
+        }
+        // Only the last REPEAT_HISTORY clocks are held; keep the distance bounded
+        if ((uint16_t)(now - ts->repeatValid) > REPEAT_HISTORY) ts->repeatValid = (uint16_t)(now - REPEAT_HISTORY);
+        ts->repeatHist[now & (REPEAT_HISTORY - 1)] = (uint8_t)finalStep;
+        return finalStep;
+    }
+
+    if (!ts->repeating) {
+        ts->repeating = true;
+        ts->repeatStart = now;
+    }
+    uint16_t start = ts->repeatStart;
+    int span = walkLen >> repeat;
+    if (span < 1) span = 1;
+    int recorded = (uint16_t)(start - ts->repeatValid);
+    if (span > recorded) span = recorded;
+    if (span < 1) return finalStep; // Nothing played yet to repeat
+
+    int elapsed = (uint16_t)(now - start);
+    return ts->repeatHist[(uint16_t)(start - span + elapsed % span) & (REPEAT_HISTORY - 1)];
+}
+
 // ============================================================================
 // TRACK PROCESSING
 // ============================================================================
@@ -387,6 +648,113 @@ static void playTrackEvents(MidiLooperAlgorithm* alg, int track, int finalStep,
 // - Binary filters operate on the fully-modified result
 // - lastStep comparison uses previous cycle's FINAL step, not base step
 //
+// All three stages work on walk positions (1..walkLen); the loop window's
+// stepMap turns the result into the step that plays (see refreshStepMap).
+//
+
+// Stages 1-3 for an independent track; advances loopCount on wrap
+static int calculateFinalStep(MidiLooperAlgorithm* alg, int track, TrackParams& tp, int walkLen, int prevPos,
+                              bool& wrapped) {
+    TrackState* ts = &alg->trackStates[track];
+
+    // Stage 1: Base step from direction mode
+    int baseStep = calculateTrackStep(alg, track, walkLen, tp.direction());
+    // Stage 2: Continuous probability-based modifiers
+    int modifiedStep = applyModifiers(alg, track, baseStep, walkLen);
+    // Stage 3: Binary accept/reject filters (uses lastStep from previous cycle)
+    int finalStep = applyBinaryModifiers(alg, track, modifiedStep, ts->lastStep, walkLen);
+
+    // Check for loop wrap
+    wrapped = detectWrap(prevPos, finalStep, walkLen, tp.direction(), ts->clockCount);
+    if (wrapped && ts->clockCount > 1) {
+        ts->loopCount++;
+    }
+    return finalStep;
+}
+
+// Trig conditions and step probability for the final step.
+// Returns true if the step plays; `fixed` is set when a Fixed condition applies.
+static bool passesStepGates(MidiLooperAlgorithm* alg, int track, TrackParams& tp, int finalStep, bool& fixed) {
+    TrackState* ts = &alg->trackStates[track];
+    bool fillActive = (alg->v[kParamFill] == 1);
+
+    // Per-track condition gates the entire track
+    if (!evaluateTrigCondition(tp.stepCond(), ts->loopCount, fillActive)) return false;
+
+    // Per-step conditions target specific steps
+    bool stepCondMet = true;
+    int condStepA = tp.condStepA();
+    int condStepB = tp.condStepB();
+    if (condStepA > 0 && finalStep == condStepA) {
+        stepCondMet = evaluateTrigCondition(tp.condA(), ts->loopCount, fillActive);
+    }
+    if (condStepB > 0 && finalStep == condStepB) {
+        stepCondMet = evaluateTrigCondition(tp.condB(), ts->loopCount, fillActive);
+    }
+    if (!stepCondMet) return false;
+
+    // Determine if Fixed condition applies to this step
+    fixed = (tp.stepCond() == COND_FIXED);
+    if (condStepA > 0 && finalStep == condStepA && tp.condA() == COND_FIXED) fixed = true;
+    if (condStepB > 0 && finalStep == condStepB && tp.condB() == COND_FIXED) fixed = true;
+
+    // Step probability gate (bypassed by Fixed)
+    int prob = tp.stepProb();
+    if (condStepA > 0 && finalStep == condStepA) prob = tp.probA();
+    if (condStepB > 0 && finalStep == condStepB) prob = tp.probB();
+    if (fixed) prob = 100;
+
+    return prob >= 100 || (int)(randFloat(ts->randState) * 100.0f) < prob;
+}
+
+// ============================================================================
+// CROSS-TRACK MODULATION
+// ============================================================================
+
+void beginTrackClock(MidiLooperAlgorithm* alg) {
+    MidiLooper_DTC* dtc = alg->dtc;
+    dtc->playedMask = 0;
+    for (int t = 0; t < MAX_TRACKS; t++) {
+        dtc->modVelocity[t] = 0;
+        dtc->modChance[t] = 100;
+    }
+}
+
+// Turn a modulator track's step into this clock's modulation of its Mod Dest
+// tracks (processed after it, see buildTrackOrder); emitNote() applies it
+static void applyModulatorStep(MidiLooperAlgorithm* alg, int track, const StepEvents* evs) {
+    MidiLooper_DTC* dtc = alg->dtc;
+    const TrackState* ts = &alg->trackStates[track];
+    int type = ts->settings[kTrkSetModType];
+    int dest = ts->modDest;
+
+    int maxVel = 0;
+    int lowNote = 127;
+    for (int e = 0; e < evs->count; e++) {
+        if (evs->events[e].velocity > maxVel) maxVel = evs->events[e].velocity;
+        if (evs->events[e].note < lowNote) lowNote = evs->events[e].note;
+    }
+
+    for (int d = 0; d < alg->numTracks; d++) {
+        if (d == track || !((dest >> d) & 1)) continue;
+        if (type == MOD_ACCENT) {
+            dtc->modVelocity[d] = (int16_t)clamp(dtc->modVelocity[d] + ts->settings[kTrkSetModAmount], -127, 127);
+        } else if (type == MOD_TRANSPOSE) {
+            dtc->modTranspose[d] = (int8_t)clamp(lowNote - MOD_TRANSPOSE_CENTER, -64, 63);
+        } else if (type == MOD_CHANCE) {
+            int chance = maxVel * 100 / 127;
+            if (chance < dtc->modChance[d]) dtc->modChance[d] = (uint8_t)chance;
+        }
+    }
+}
+
+// Dep Track condition, read from tracks already processed on this clock
+// (buildTrackOrder puts the dependency first)
+static bool dependencyMet(MidiLooperAlgorithm* alg, const TrackState* ts) {
+    if (ts->depTrack < 0) return true;
+    bool played = (alg->dtc->playedMask >> ts->depTrack) & 1;
+    return played == (ts->settings[kTrkSetDepMode] == DEP_PLAYED);
+}
 
 // Process a single track on clock trigger
 void processTrack(MidiLooperAlgorithm* alg, int track, bool panicOnWrap) {
@@ -398,7 +766,7 @@ void processTrack(MidiLooperAlgorithm* alg, int track, bool panicOnWrap) {
     uint32_t where = destToWhere(tp.destination());
 
     // Process note durations first (independent of step calculation)
-    processNoteDurations(alg, track);
+    int expired = processNoteDurations(alg, track, ts->settings[kTrkSetLegato] != 0);
 
     // Handle track enable/disable transitions
     bool enabled = tp.enabled();
@@ -409,62 +777,114 @@ void processTrack(MidiLooperAlgorithm* alg, int track, bool panicOnWrap) {
 
     // Advance clock and save previous position for wrap detection
     ts->clockCount++;
-    int prevPos = ts->step;
-
-    // === STEP CALCULATION PIPELINE (see documentation above) ===
-    // Stage 1: Base step from direction mode
-    int baseStep = calculateTrackStep(alg, track, loopLen, tp.direction());
-    // Stage 2: Continuous probability-based modifiers
-    int modifiedStep = applyModifiers(alg, track, baseStep, loopLen);
-    // Stage 3: Binary accept/reject filters (uses lastStep from previous cycle)
-    int finalStep = applyBinaryModifiers(alg, track, modifiedStep, ts->lastStep, loopLen);
+    int prevPos = ts->walkPos;
+
+    // Overdub feedback fades the material this pass runs over
+    decayOverdubStep(alg, track, loopLen);
+
+    int walkLen = refreshStepMap(ts, loopLen);
+    int walkPos;
+    bool wrapped = false;
+    if (walkLen == 0) {
+        // Every step in the window is skipped: the track rests
+        walkPos = 0;
+    } else if (ts->leader >= 0) {
+        // Follower: reuse the leader's result from this clock instead of
+        // running the pipeline (the leader is always processed first)
+        const TrackState* lead = &alg->trackStates[ts->leader];
+        int offset = ts->settings[kTrkSetFollowOfs];
+        if (lead->walkPos == 0) {
+            walkPos = 0; // The leader rests, so the follower does too
+        } else {
+            walkPos = (((lead->walkPos - 1 + offset) % walkLen) + walkLen) % walkLen + 1;
+        }
+        wrapped = lead->wrapped;
+        ts->loopCount = lead->loopCount;
+    } else {
+        // === STEP CALCULATION PIPELINE (see documentation above) ===
+        walkPos = calculateFinalStep(alg, track, tp, walkLen, prevPos, wrapped);
+    }
+    int finalStep = (walkPos > 0) ? ts->stepMap[walkPos - 1] : 0;
 
     // Update state with final calculated step
-    ts->lastStep = (uint8_t)finalStep;
+    if (walkPos > 0) ts->lastStep = (uint8_t)walkPos;
+    ts->walkPos = (uint8_t)walkPos;
     ts->step = (uint8_t)finalStep;
+    ts->wrapped = wrapped;
 
-    // Check for loop wrap and trigger panic if configured
-    bool wrapped = detectWrap(prevPos, finalStep, loopLen, tp.direction(), ts->clockCount);
-    if (wrapped && ts->clockCount > 1) {
-        ts->loopCount++;
-    }
+    // Beat repeat plays a remembered step; the playhead above carries on
+    int playStep = applyBeatRepeat(alg, ts, walkLen, finalStep);
+
+    // Trigger panic if configured
     if (wrapped && panicOnWrap) {
         handlePanicOnWrap(alg, track);
     }
+    if (wrapped) {
+        applyPendingEdits(alg, track);
+        if (launchWaitsForWrap(alg->dtc, ts, track)) switchPattern(alg, track);
+    }
 
-    // Emit notes for the calculated step(s), gated by trig conditions
-    if (enabled) {
-        bool fillActive = (alg->v[kParamFill] == 1);
+    // Emit notes for the calculated step(s), gated by trig conditions and the
+    // Dep Track's result. Muted tracks still evaluate the gates so conditions
+    // and randomness stay in step, and still count as played.
+    bool fixed = false;
+    bool plays = enabled && playStep > 0 && passesStepGates(alg, track, tp, playStep, fixed) &&
+                 dependencyMet(alg, ts);
+    if (plays && ts->data->steps[playStep - 1].count > 0) {
+        alg->dtc->playedMask |= (uint8_t)(1u << track);
+        if (ts->modulates) applyModulatorStep(alg, track, &ts->data->steps[playStep - 1]);
+    }
+    if (plays && !ts->modulates && trackAudible(alg->dtc, track)) {
+        playTrackEvents(alg, track, playStep, tp, tp.velocity(), tp.humanize(), outCh, where, fixed);
+    }
 
-        // Per-track condition gates the entire track
-        if (evaluateTrigCondition(tp.stepCond(), ts->loopCount, fillActive)) {
-            // Per-step conditions target specific steps
-            bool stepCondMet = true;
-            int condStepA = tp.condStepA();
-            int condStepB = tp.condStepB();
-            if (condStepA > 0 && finalStep == condStepA) {
-                stepCondMet = evaluateTrigCondition(tp.condA(), ts->loopCount, fillActive);
-            }
-            if (condStepB > 0 && finalStep == condStepB) {
-                stepCondMet = evaluateTrigCondition(tp.condB(), ts->loopCount, fillActive);
-            }
+    // Legato: old notes end only after the new ones have started
+    if (expired > 0) {
+        releaseExpiredNotes(alg, track);
+    }
+}
 
-            if (stepCondMet) {
-                // Determine if Fixed condition applies to this step
-                bool fixed = (tp.stepCond() == COND_FIXED);
-                if (condStepA > 0 && finalStep == condStepA && tp.condA() == COND_FIXED) fixed = true;
-                if (condStepB > 0 && finalStep == condStepB && tp.condB() == COND_FIXED) fixed = true;
+// ============================================================================
+// OFFLINE RENDERING (Freeze)
+// ============================================================================
 
-                // Step probability gate (bypassed by Fixed)
-                int prob = tp.stepProb();
-                if (condStepA > 0 && finalStep == condStepA) prob = tp.probA();
-                if (condStepB > 0 && finalStep == condStepB) prob = tp.probB();
-                if (fixed) prob = 100;
+// Run one clock of the track's step pipeline, writing the notes it would play
+// into `out` instead of sending them. Draws from the track's PRNG in the same
+// order as processTrack(), so the caller controls the result by what playback
+// state (see PlayCursor) is loaded when this runs.
+void renderTrackClock(MidiLooperAlgorithm* alg, int track, StepEvents* out) {
+    TrackState* ts = &alg->trackStates[track];
+    TrackParams tp = TrackParams::fromAlgorithm(alg->v, track);
+    int loopLen = tp.length();
 
-                if (prob >= 100 || (int)(randFloat(ts->randState) * 100.0f) < prob) {
-                    playTrackEvents(alg, track, finalStep, tp, tp.velocity(), tp.humanize(), outCh, where, fixed);
-                }
-            }
-        }
+    ts->clockCount++;
+    int walkLen = refreshStepMap(ts, loopLen);
+    if (walkLen == 0) return;
+
+    bool wrapped;
+    int walkPos = calculateFinalStep(alg, track, tp, walkLen, ts->walkPos, wrapped);
+    int finalStep = ts->stepMap[walkPos - 1];
+    ts->lastStep = (uint8_t)walkPos;
+    ts->walkPos = (uint8_t)walkPos;
+    ts->step = (uint8_t)finalStep;
+
+    bool fixed = false;
+    if (!passesStepGates(alg, track, tp, finalStep, fixed)) return;
+
+    const StepEvents* evs = &ts->data->steps[finalStep - 1];
+    if (evs->count == 0) return;
+
+    int noteShift = fixed ? 0 : calculateOctaveJump(alg, track, tp);
+    int humanize = tp.humanize();
+    int density = alg->v[kParamPlayDensity];
+    for (int e = 0; e < evs->count; e++) {
+        if (density < 100 && ts->eventRank[finalStep - 1][e] >= density) continue;
+        const NoteEvent* ev = &evs->events[e];
+        // Stored unquantized so the frozen track still follows the scale
+        int note = clamp((int)ev->note + noteShift, 0, 127);
+        int velocity = clamp((int)ev->velocity + tp.velocity(), 0, 127);
+        // Humanize delays are sub-step; keep the draw so later steps match playback
+        if (humanize > 0) randRange(ts->randState, 0, humanize);
+        if (velocity > 0) addEvent(out, (uint8_t)note, (uint8_t)velocity, ev->duration);
     }
 }
@@ -7,6 +7,9 @@
 
 #include "types.h"
 
+// Clock processing order (Follow settings)
+void buildTrackOrder(MidiLooperAlgorithm* alg);
+
 // Transport control
 void handleTransportStart(MidiLooperAlgorithm* alg);
 void handleTransportStop(MidiLooperAlgorithm* alg);
@@ -15,4 +18,6 @@ void handleTransportStop(MidiLooperAlgorithm* alg);
 void processDelayedNotes(MidiLooperAlgorithm* alg, float dt);
 
 // Track processing
+void beginTrackClock(MidiLooperAlgorithm* alg); // Before the first processTrack() of a clock
 void processTrack(MidiLooperAlgorithm* alg, int track, bool panicOnWrap);
+void renderTrackClock(MidiLooperAlgorithm* alg, int track, StepEvents* out);
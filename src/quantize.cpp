@@ -1,4 +1,5 @@
 #include "quantize.h"
+#include "scales.h"
 
 // ============================================================================
 // QUANTIZATION CALCULATIONS
@@ -65,3 +66,38 @@ int calcQuantizedDuration(int duration, int quantize) {
     int quantizedDur = ((duration + quantize / 2) / quantize) * quantize;
     return (quantizedDur < quantize) ? quantize : quantizedDur;
 }
+
+// ============================================================================
+// PITCH QUANTIZATION
+// ============================================================================
+
+// Compile the active Scale Root/Scale into the lookup table shared by input,
+// playback and generation. Built-in, user and note-map scales all end up as
+// the same 128-entry table, so every note costs one load regardless of type.
+void updateScaleLut(MidiLooperAlgorithm* alg) {
+    uint8_t* lut = alg->dtc->scaleLut;
+    int root = clampParam(alg->v[kParamScaleRoot], 0, 11);
+    int scaleType = alg->v[kParamScaleType];
+
+    if (scaleType == SCALE_NOTE_MAP) {
+        for (int n = 0; n < 128; n++) {
+            lut[n] = alg->pitchMap[n];
+        }
+        return;
+    }
+
+    uint16_t mask = SCALE_MASK_CHROMATIC;
+    if (scaleType > SCALE_OFF && scaleType < SCALE_BUILTIN_COUNT) {
+        mask = scaleMasks[scaleType - 1];
+    } else if (scaleType >= SCALE_USER1 && scaleType < SCALE_USER1 + NUM_USER_SCALES) {
+        mask = (uint16_t)alg->dtc->settings[kSetUserScale1 + (scaleType - SCALE_USER1)];
+    }
+
+    if (mask == SCALE_MASK_CHROMATIC) {
+        for (int n = 0; n < 128; n++) {
+            lut[n] = (uint8_t)n;
+        }
+        return;
+    }
+    buildScaleLut(lut, root, mask);
+}
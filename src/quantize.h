@@ -1,6 +1,6 @@
 /*
  * MIDI Looper - Quantization Utilities
- * Step quantization and snap functions for recording
+ * Step quantization and snap functions for recording, pitch quantization
  */
 
 #pragma once
@@ -18,3 +18,10 @@ int snapToDivisionSubclock(int rawStep, float stepFraction, int quantize, float
 
 // Duration quantization
 int calcQuantizedDuration(int duration, int quantize);
+
+// Pitch quantization (per-instance lookup table, rebuilt on scale changes)
+void updateScaleLut(MidiLooperAlgorithm* alg);
+
+static inline uint8_t quantizeNote(const MidiLooperAlgorithm* alg, int note) {
+    return alg->dtc->scaleLut[note & 0x7F];
+}
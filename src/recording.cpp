@@ -1,17 +1,37 @@
 #include "recording.h"
+#include "analysis.h"
+#include "capture.h"
+#include "metronome.h"
 #include "midi.h"
+#include "midi_utils.h"
 
 // ============================================================================
 // RECORDING OPERATIONS
 // ============================================================================
 
+HeldNote* findHeldNote(MidiLooperAlgorithm* alg, uint8_t note) {
+    for (int i = 0; i < alg->numHeldNotes; i++) {
+        HeldNote* held = &alg->heldNotes[i];
+        if (held->active && held->note == note) return held;
+    }
+    return NULL;
+}
+
 void recordNoteOn(
     MidiLooperAlgorithm* alg,
     const RecordingContext& ctx,
     uint8_t note,
     uint8_t velocity
 ) {
-    HeldNote* held = &alg->heldNotes[note];
+    // A retriggered note reuses its slot; otherwise take a free one
+    HeldNote* held = findHeldNote(alg, note);
+    for (int i = 0; !held && i < alg->numHeldNotes; i++) {
+        if (!alg->heldNotes[i].active) held = &alg->heldNotes[i];
+    }
+    if (!held) {
+        DEBUG_POOL_OVERFLOW("heldNotes");
+        return;
+    }
     held->active = true;
     held->note = note;
     held->velocity = velocity;
@@ -32,8 +52,8 @@ void recordNoteOff(
     const RecordingContext& ctx,
     uint8_t note
 ) {
-    HeldNote* held = &alg->heldNotes[note];
-    if (!held->active) return;
+    HeldNote* held = findHeldNote(alg, note);
+    if (!held) return;
 
     int effectiveEndStep = snapStepSubclock(
         ctx.rawStep, ctx.stepFraction, ctx.snapThreshold, held->loopLen
@@ -47,23 +67,26 @@ void recordNoteOff(
     int maxDuration = held->loopLen - held->quantizedStep + 1;
     if (duration > maxDuration) duration = maxDuration;
 
-    // Store the event
+    // Store the event (at the loop window position it was played at)
     int heldTrack = safeTrackIndex(held->track);
-    int heldStepIdx = safeStepIndex(held->quantizedStep - 1);
-    StepEvents* evs = &alg->trackStates[heldTrack].data.steps[heldStepIdx];
+    TrackState* ts = &alg->trackStates[heldTrack];
+    int heldStepIdx = safeStepIndex(windowStep(ts, held->quantizedStep) - 1);
 
-    addEvent(evs, note, held->velocity, (uint16_t)duration);
+    if (addEvent(&ts->data->steps[heldStepIdx], note, held->velocity, (uint16_t)duration)) {
+        analysisAddEvent(ts, note, held->velocity, (uint16_t)duration);
+    }
 
     held->active = false;
 }
 
 void finalizeHeldNotes(MidiLooperAlgorithm* alg) {
-    for (int noteNum = 0; noteNum < 128; noteNum++) {
-        HeldNote* held = &alg->heldNotes[noteNum];
+    for (int i = 0; i < alg->numHeldNotes; i++) {
+        HeldNote* held = &alg->heldNotes[i];
         if (!held->active) continue;
 
         int track = safeTrackIndex(held->track);
-        int currentStep = clamp(alg->trackStates[track].step, 1, held->loopLen);
+        TrackState* ts = &alg->trackStates[track];
+        int currentStep = clamp(windowPos(ts, ts->step), 1, held->loopLen);
 
         int duration = currentStep - held->effectiveStep;
         if (duration < 0) duration += held->loopLen;
@@ -73,21 +96,59 @@ void finalizeHeldNotes(MidiLooperAlgorithm* alg) {
         int maxDuration = held->loopLen - held->quantizedStep + 1;
         if (duration > maxDuration) duration = maxDuration;
 
-        int stepIdx = safeStepIndex(held->quantizedStep - 1);
-        StepEvents* evs = &alg->trackStates[track].data.steps[stepIdx];
+        int stepIdx = safeStepIndex(windowStep(ts, held->quantizedStep) - 1);
 
-        addEvent(evs, (uint8_t)noteNum, held->velocity, (uint16_t)duration);
+        if (addEvent(&ts->data->steps[stepIdx], held->note, held->velocity, (uint16_t)duration)) {
+            analysisAddEvent(ts, held->note, held->velocity, (uint16_t)duration);
+        }
 
         held->active = false;
     }
 }
 
 void clearHeldNotes(MidiLooperAlgorithm* alg) {
-    for (int i = 0; i < 128; i++) {
+    for (int i = 0; i < alg->numHeldNotes; i++) {
         alg->heldNotes[i].active = false;
     }
 }
 
+// ============================================================================
+// OVERDUB FEEDBACK
+// ============================================================================
+
+// Fade one step of the track being overdubbed (called once per track tick).
+// The step follows the tick count rather than the playhead, so each step fades
+// exactly once per pass whatever the direction, spread over the loop instead
+// of a whole-track sweep at the wrap.
+void decayOverdubStep(MidiLooperAlgorithm* alg, int track, int loopLen) {
+    const int16_t* v = alg->v;
+    int feedback = v[kParamFeedback];
+    if (feedback >= 100 || alg->dtc->recordState != REC_LIVE || v[kParamRecMode] != REC_MODE_OVERDUB) return;
+    if (track != clampParam(v[kParamRecTrack], 0, alg->numTracks - 1)) return;
+
+    TrackState* ts = &alg->trackStates[track];
+    int pos = (ts->clockCount - 1) % loopLen;
+    int stepIdx = windowStep(ts, pos + 1) - 1;
+    StepEvents* evs = &ts->data->steps[stepIdx];
+    uint8_t* rank = ts->eventRank[stepIdx];
+
+    // The histogram follows each faded event; ranks are rebuilt once per pass,
+    // and until then move along with the events that stay
+    int kept = 0;
+    for (int i = 0; i < evs->count; i++) {
+        NoteEvent ev = evs->events[i];
+        int velocity = ev.velocity * feedback / 100;
+        if (velocity < FEEDBACK_MIN_VELOCITY) velocity = 0;
+        analysisFadeEvent(ts, ev.note, ev.velocity, (uint8_t)velocity, ev.duration);
+        if (velocity == 0) continue;
+        ev.velocity = (uint8_t)velocity;
+        rank[kept] = rank[i];
+        evs->events[kept++] = ev;
+    }
+    evs->count = (uint8_t)kept;
+    if (pos == loopLen - 1) ts->ranksDirty = true;
+}
+
 // ============================================================================
 // STEP RECORD OPERATIONS
 // ============================================================================
@@ -107,10 +168,12 @@ void stepRecordNoteOn(MidiLooperAlgorithm* alg, int track, uint8_t note, uint8_t
     int maxDuration = loopLen - rawStep + 1;
     if (duration > maxDuration) duration = maxDuration;
 
-    int stepIdx = safeStepIndex(rawStep - 1);
-    StepEvents* evs = &alg->trackStates[safeTrackIndex(track)].data.steps[stepIdx];
+    TrackState* ts = &alg->trackStates[safeTrackIndex(track)];
+    int stepIdx = safeStepIndex(windowStep(ts, rawStep) - 1);
 
-    addEvent(evs, note, velocity, (uint16_t)duration);
+    if (addEvent(&ts->data->steps[stepIdx], note, velocity, (uint16_t)duration)) {
+        analysisAddEvent(ts, note, velocity, (uint16_t)duration);
+    }
 }
 
 void stepRecordNoteOff(MidiLooperAlgorithm* alg, int track, uint8_t note) {
@@ -133,3 +196,89 @@ void stepRecordNoteOff(MidiLooperAlgorithm* alg, int track, uint8_t note) {
         dtc->stepRecPos = 1;
     }
 }
+
+// ============================================================================
+// NOTE INPUT
+// ============================================================================
+
+void inputNote(MidiLooperAlgorithm* alg, uint8_t note, bool noteOn, uint8_t velocity, int inCh, float stepTime) {
+    MidiLooper_DTC* dtc = alg->dtc;
+    const int16_t* v = alg->v;
+
+    int track = clampParam(v[kParamRecTrack], 0, alg->numTracks - 1);
+    TrackParams tp = TrackParams::fromAlgorithm(v, track);
+    int outCh = tp.channel();
+    uint32_t where = destToWhere(tp.destination());
+
+    // Scale quantization (applied at input, before pass-through and recording)
+    if (noteOn) {
+        uint8_t quantized = quantizeNote(alg, note);
+        dtc->noteMap[note] = quantized;
+        note = quantized;
+    } else {
+        note = dtc->noteMap[note];
+    }
+
+    // Pass-through (if input channel differs from output)
+    if (inCh != outCh) {
+        NT_sendMidi3ByteMessage(where, withChannel(noteOn ? kMidiNoteOn : kMidiNoteOff, outCh), note, velocity);
+    }
+
+    // Input history for retrospective capture
+    if (transportIsRunning(dtc->transportState)) {
+        captureInputNote(alg, note, noteOn ? velocity : 0);
+    }
+
+    // Update input display state
+    if (noteOn) {
+        dtc->inputNotes[note] = 1;
+        dtc->inputVel = velocity;
+    } else {
+        dtc->inputNotes[note] = 0;
+        // Check if any notes still held
+        bool anyHeld = false;
+        for (int n = 0; n < 128; n++) {
+            if (dtc->inputNotes[n]) {
+                anyHeld = true;
+                break;
+            }
+        }
+        if (!anyHeld) {
+            dtc->inputVel = 0;
+        }
+    }
+
+    // Step recording - process independently of transport
+    if (dtc->recordState == REC_STEP) {
+        if (noteOn) {
+            stepRecordNoteOn(alg, track, note, velocity);
+        } else {
+            stepRecordNoteOff(alg, track, note);
+        }
+        return;
+    }
+
+    // Count-in - notes just before the downbeat are recorded onto step 1
+    if (dtc->recordState == REC_COUNT_IN) {
+        countInNote(alg, track, note, noteOn ? velocity : 0);
+        return;
+    }
+
+    // Live recording - only process if in recording state
+    if (dtc->recordState != REC_LIVE) return;
+
+    // Create recording context with current state (uses cached quantize);
+    // positions are relative to the loop window, and a divided step also
+    // counts the clocks already received inside it (before the first step,
+    // notes land on step 1)
+    TrackState* ts = &alg->trackStates[track];
+    float stepPos = (ts->step == 0) ? 0.0f : stepTime + ts->divCounter * dtc->stepDuration;
+    RecordingContext ctx = createRecordingContext(v, track, windowPos(ts, ts->step), stepPos,
+                                                  dtc->stepDuration * tp.clockDiv(), &ts->cache);
+
+    if (noteOn) {
+        recordNoteOn(alg, ctx, note, velocity);
+    } else {
+        recordNoteOff(alg, ctx, note);
+    }
+}
@@ -42,12 +42,21 @@ inline RecordingContext createRecordingContext(
     return ctx;
 }
 
+// Held note for a pitch, or NULL when it is not being held
+HeldNote* findHeldNote(MidiLooperAlgorithm* alg, uint8_t note);
+
 // Recording operations
 void recordNoteOn(MidiLooperAlgorithm* alg, const RecordingContext& ctx, uint8_t note, uint8_t velocity);
 void recordNoteOff(MidiLooperAlgorithm* alg, const RecordingContext& ctx, uint8_t note);
 void finalizeHeldNotes(MidiLooperAlgorithm* alg);
 void clearHeldNotes(MidiLooperAlgorithm* alg);
+void decayOverdubStep(MidiLooperAlgorithm* alg, int track, int loopLen);
 
 // Step record operations
 void stepRecordNoteOn(MidiLooperAlgorithm* alg, int track, uint8_t note, uint8_t velocity);
 void stepRecordNoteOff(MidiLooperAlgorithm* alg, int track, uint8_t note);
+
+// Note input from MIDI or CV: scale quantization, pass-through, capture
+// history, display and recording. inCh is the MIDI channel (1-16, 0 = CV);
+// stepTime is the note's time since the last clock.
+void inputNote(MidiLooperAlgorithm* alg, uint8_t note, bool noteOn, uint8_t velocity, int inCh, float stepTime);
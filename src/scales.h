@@ -1,6 +1,6 @@
 /*
  * MIDI Looper - Scale Quantization
- * White-key-to-scale mapping for musical scale quantization
+ * Pitch-class masks and the per-instance quantization lookup table
  */
 
 #pragma once
@@ -25,31 +25,41 @@ enum ScaleType {
     SCALE_MAJ_PENTATONIC,
     SCALE_MIN_PENTATONIC,
 
-    SCALE_COUNT  // = 12
+    SCALE_BUILTIN_COUNT,  // = 12
+
+    SCALE_USER1 = SCALE_BUILTIN_COUNT,  // User Scl 1-4 settings
+    SCALE_USER2,
+    SCALE_USER3,
+    SCALE_USER4,
+    SCALE_NOTE_MAP,                     // 128-entry note map from the preset
+
+    SCALE_COUNT  // = 17
 };
 
+static constexpr int NUM_USER_SCALES = 4;
+
 // ============================================================================
-// SCALE INTERVAL TABLES (0-based semitone offsets from root)
+// SCALE MASKS (bit n = n semitones above root)
 // ============================================================================
 
-static const int scaleIntervals[][7] = {
-    { 0, 2, 4, 5, 7, 9, 11 },  // Ionian (Major)
-    { 0, 2, 3, 5, 7, 9, 10 },  // Dorian
-    { 0, 1, 3, 5, 7, 8, 10 },  // Phrygian
-    { 0, 2, 4, 6, 7, 9, 11 },  // Lydian
-    { 0, 2, 4, 5, 7, 9, 10 },  // Mixolydian
-    { 0, 2, 3, 5, 7, 8, 10 },  // Aeolian (Natural Minor)
-    { 0, 1, 3, 5, 6, 8, 10 },  // Locrian
-    { 0, 2, 3, 5, 7, 8, 11 },  // Harmonic Minor
-    { 0, 2, 3, 5, 7, 9, 11 },  // Melodic Minor
-    { 0, 2, 4, 7, 9, 0, 0 },   // Major Pentatonic (5 notes, last 2 unused)
-    { 0, 3, 5, 7, 10, 0, 0 },  // Minor Pentatonic (5 notes, last 2 unused)
+static const uint16_t scaleMasks[] = {
+    0xAB5,  // Ionian (Major)          0 2 4 5 7 9 11
+    0x6AD,  // Dorian                  0 2 3 5 7 9 10
+    0x5AB,  // Phrygian                0 1 3 5 7 8 10
+    0xAD5,  // Lydian                  0 2 4 6 7 9 11
+    0x6B5,  // Mixolydian              0 2 4 5 7 9 10
+    0x5AD,  // Aeolian (Natural Minor) 0 2 3 5 7 8 10
+    0x56B,  // Locrian                 0 1 3 5 6 8 10
+    0x9AD,  // Harmonic Minor          0 2 3 5 7 8 11
+    0xAAD,  // Melodic Minor           0 2 3 5 7 9 11
+    0x295,  // Major Pentatonic        0 2 4 7 9
+    0x4A9,  // Minor Pentatonic        0 3 5 7 10
 };
 
-// Number of notes per scale
-static const int scaleSizes[] = {
-    7, 7, 7, 7, 7, 7, 7, 7, 7, 5, 5
-};
+static_assert(sizeof(scaleMasks) / sizeof(scaleMasks[0]) == SCALE_BUILTIN_COUNT - 1,
+              "Scale mask table size mismatch - update table when adding scales");
+
+static constexpr uint16_t SCALE_MASK_CHROMATIC = 0xFFF;
 
 // ============================================================================
 // WHITE KEY LOOKUP TABLE
@@ -63,31 +73,36 @@ static const int PC_TO_WHITE_KEY[12] = {
 };
 
 // ============================================================================
-// QUANTIZATION FUNCTION
+// LOOKUP TABLE BUILDER
 // ============================================================================
 
-// Quantize a MIDI note to a given root + scale combination.
-// Maps white key positions to scale degrees, with octave wrapping for
-// pentatonic scales (7 white keys > 5 scale degrees).
-// Returns the note unchanged when scaleType == SCALE_OFF.
-static inline uint8_t quantizeToScale(uint8_t note, int root, int scaleType) {
-    if (scaleType <= SCALE_OFF || scaleType >= SCALE_COUNT) return note;
-
-    int scaleIdx = scaleType - 1;  // Interval table is 0-indexed (no OFF entry)
-    int scaleSize = scaleSizes[scaleIdx];
-
-    int pc = note % 12;
-    int octave = note / 12;
-    int whiteKeyIdx = PC_TO_WHITE_KEY[pc];
-
-    int extraOctave = whiteKeyIdx / scaleSize;
-    int scaleDegree = whiteKeyIdx % scaleSize;
-
-    int outNote = (octave + extraOctave) * 12 + root + scaleIntervals[scaleIdx][scaleDegree];
-
-    // Clamp to MIDI range
-    if (outNote < 0) outNote = 0;
-    if (outNote > 127) outNote = 127;
-
-    return (uint8_t)outNote;
+// Fill a 128-entry note → note table for a root + scale mask.
+// Scales of up to 7 notes map white key positions to scale degrees, with
+// octave wrapping for smaller scales (7 white keys > 5 pentatonic degrees).
+// Larger scales can't be reached from white keys alone, so every note snaps
+// down to the nearest scale tone instead.
+static inline void buildScaleLut(uint8_t* lut, int root, uint16_t mask) {
+    int degrees[12];
+    int numDegrees = 0;
+    for (int i = 0; i < 12; i++) {
+        if (mask & (1u << i)) degrees[numDegrees++] = i;
+    }
+
+    for (int note = 0; note < 128; note++) {
+        int outNote = note;
+        if (numDegrees > 0 && numDegrees <= 7) {
+            int octave = note / 12;
+            int whiteKeyIdx = PC_TO_WHITE_KEY[note % 12];
+            int extraOctave = whiteKeyIdx / numDegrees;
+            int scaleDegree = whiteKeyIdx % numDegrees;
+            outNote = (octave + extraOctave) * 12 + root + degrees[scaleDegree];
+        } else if (numDegrees > 7) {
+            while (!(mask & (1u << (((outNote - root) % 12 + 12) % 12)))) outNote--;
+        }
+
+        // Clamp to MIDI range
+        if (outNote < 0) outNote = 0;
+        if (outNote > 127) outNote = 127;
+        lut[note] = (uint8_t)outNote;
+    }
 }
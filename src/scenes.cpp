@@ -0,0 +1,117 @@
+/*
+ * MIDI Looper - Scenes
+ *
+ * A scene holds every per-track parameter and per-track setting. Recall only
+ * records the scene; at the quantize point (next bar or loop of the Rec Track,
+ * on the clock that starts it) the scene is compared with the parameters as
+ * they are then, so changes made while waiting are taken into account. Only
+ * parameters that differ are written, all in that one block so the new bar
+ * starts on the whole scene: one compare per track parameter, plus one host
+ * parameter write per difference (at most PARAMS_PER_TRACK x tracks when
+ * every value changes). The settings are copied and derived state (track
+ * order) is rebuilt once.
+ */
+
+#include "scenes.h"
+#include <cstring>
+#include "math.h"
+#include "metronome.h"
+#include "playback.h"
+#include "settings.h"
+
+void initScenes(SceneBank* bank) {
+    for (int i = 0; i < NUM_SCENES; i++) {
+        bank->scenes[i].stored = false;
+    }
+    bank->recall.active = false;
+}
+
+static int selectedScene(MidiLooperAlgorithm* alg) {
+    return getSetting(alg, kSetScene) - 1;
+}
+
+// ============================================================================
+// STORE / RECALL
+// ============================================================================
+
+void storeScene(MidiLooperAlgorithm* alg) {
+    Scene* scene = &alg->scenes->scenes[selectedScene(alg)];
+    for (int t = 0; t < alg->numTracks; t++) {
+        memcpy(scene->params[t], &alg->v[trackParam(t, 0)], sizeof(scene->params[t]));
+        memcpy(scene->settings[t], alg->trackStates[t].settings, sizeof(scene->settings[t]));
+    }
+    scene->stored = true;
+}
+
+void recallScene(MidiLooperAlgorithm* alg) {
+    int index = selectedScene(alg);
+    const Scene* scene = &alg->scenes->scenes[index];
+    if (!scene->stored) return;
+
+    SceneRecall* recall = &alg->scenes->recall;
+    recall->scene = (uint8_t)index;
+    recall->due = false;
+    recall->active = true;
+}
+
+static void applySceneRecall(MidiLooperAlgorithm* alg) {
+    SceneRecall* recall = &alg->scenes->recall;
+    const Scene* scene = &alg->scenes->scenes[recall->scene];
+
+    for (int t = 0; t < alg->numTracks; t++) {
+        for (int p = 0; p < PARAMS_PER_TRACK; p++) {
+            int param = trackParam(t, p);
+            if (alg->v[param] != scene->params[t][p]) setParameterValue(alg, param, scene->params[t][p]);
+        }
+        memcpy(alg->trackStates[t].settings, scene->settings[t], sizeof(scene->settings[t]));
+    }
+    buildTrackOrder(alg);
+    alg->dtc->settingSyncPending = true;
+    recall->active = false;
+}
+
+// ============================================================================
+// QUANTIZED APPLY
+// ============================================================================
+
+// Apply a pending recall: immediately for Scene Quant = Now or with the
+// transport stopped, otherwise on the first clock of the next bar/loop
+void processSceneRecall(MidiLooperAlgorithm* alg, bool clockEdge) {
+    SceneRecall* recall = &alg->scenes->recall;
+    if (!recall->active) return;
+
+    bool now = getSetting(alg, kSetSceneQuant) == SCENE_QUANT_NOW ||
+               !transportIsRunning(alg->dtc->transportState);
+    if (now || (clockEdge && recall->due)) {
+        applySceneRecall(alg);
+    }
+}
+
+// After a clock: note when the Rec Track has just finished a bar or loop
+void sceneClockProcessed(MidiLooperAlgorithm* alg) {
+    SceneRecall* recall = &alg->scenes->recall;
+    if (!recall->active) return;
+
+    int span = (getSetting(alg, kSetSceneQuant) == SCENE_QUANT_LOOP) ? SPAN_LOOP : SPAN_BAR;
+    if (recTrackSpanEnded(alg, span)) {
+        recall->due = true;
+    }
+}
+
+// ============================================================================
+// PRESET LOADING
+// ============================================================================
+
+void validateScene(MidiLooperAlgorithm* alg, int index) {
+    Scene* scene = &alg->scenes->scenes[index];
+    for (int t = 0; t < alg->numTracks; t++) {
+        for (int p = 0; p < PARAMS_PER_TRACK; p++) {
+            const _NT_parameter& def = alg->parameters[trackParam(t, p)];
+            scene->params[t][p] = (int16_t)clamp(scene->params[t][p], def.min, def.max);
+        }
+        for (int i = 0; i < kTrackSettingCount; i++) {
+            scene->settings[t][i] = (int16_t)clampTrackSetting(i, scene->settings[t][i]);
+        }
+    }
+    scene->stored = true;
+}
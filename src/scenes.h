@@ -0,0 +1,21 @@
+/*
+ * MIDI Looper - Scenes
+ * Snapshots of all per-track parameters and settings with quantized recall
+ */
+
+#pragma once
+
+#include "types.h"
+
+void initScenes(SceneBank* bank);
+
+// Store/Recall actions (slot from the Scene setting)
+void storeScene(MidiLooperAlgorithm* alg);
+void recallScene(MidiLooperAlgorithm* alg);
+
+// Quantized recall (called from step())
+void processSceneRecall(MidiLooperAlgorithm* alg, bool clockEdge);
+void sceneClockProcessed(MidiLooperAlgorithm* alg);
+
+// Clamp a scene loaded from a preset to the parameter and setting ranges
+void validateScene(MidiLooperAlgorithm* alg, int scene);
@@ -6,16 +6,42 @@
  * {
  *   "version": 1,
  *   "numTracks": 4,
+ *   "settings": [1, 0, 0, 0, 0, ...],        // kSet* order
+ *   "pitchMap": [0, 1, 2, ...],              // 128 entries, Note Map scale
+ *   "scenes": [                              // stored scene slots only
+ *     {
+ *       "slot": 0,
+ *       "params": [[1, 16, 1, ...], ...],      // per track, kTrack* order
+ *       "settings": [[0, 0, 0], ...]           // per track, kTrkSet* order
+ *     },
+ *     ...
+ *   ],
+ *   "ccMap": [                               // MIDI learn mappings
+ *     {"ch": 0, "cc": 74, "type": 0, "target": 12, "min": 0, "max": 127},
+ *     ...
+ *   ],
+ *   "clockTicks": 148,                       // resume state: clocks since start
  *   "tracks": [
  *     {
- *       "events": [
+ *       "pattern": 0,                            // playing slot
+ *       "events": [                              // playing slot's steps
  *         [{"n": 60, "v": 100, "d": 48}, ...],  // step 0
  *         [],                                      // step 1 (empty)
  *         ...
  *       ],
  *       "shuffleOrder": [1, 2, 3, ...],
  *       "shufflePos": 1,
- *       "brownianPos": 1
+ *       "brownianPos": 1,
+ *       "clockCount": 37, "divCounter": 0,       // resume state: counters,
+ *       "loopCount": 2, "octaveCount": 5,        // position and PRNG
+ *       "step": 5, "walkPos": 5, "lastStep": 4,
+ *       "randState": -1640531527,
+ *       "settings": [0, 0],                      // kTrkSet* order
+ *       "skip": [3, 7],                          // skipped steps (0-based)
+ *       "patterns": [                            // other non-empty slots
+ *         {"slot": 2, "program": 0, "bank": 0, "events": [...]},
+ *         ...
+ *       ]
  *     },
  *     ...
  *   ]
@@ -44,14 +70,132 @@
  */
 
 #include "serial.h"
+#include <cstring>
+#include "cclearn.h"
+#include "math.h"
 #include "midi.h"
+#include "quantize.h"
+#include "scenes.h"
+#include "settings.h"
 
 static const int SERIAL_VERSION = 1;
 
+// ============================================================================
+// SAVE STAGING
+// ============================================================================
+
+// step() and midiMessage() preempt serialise, and each bumps writeSeq. A copy
+// that starts and ends on the same writeSeq saw no audio call, so it is
+// consistent; only the track being copied is staged, never the whole bank.
+static uint32_t readWriteSeq(const MidiLooper_DTC* dtc) {
+    __atomic_signal_fence(__ATOMIC_SEQ_CST);
+    uint32_t seq = *(const volatile uint32_t*)&dtc->writeSeq;
+    __atomic_signal_fence(__ATOMIC_SEQ_CST);
+    return seq;
+}
+
+static void copyCursor(PlayCursor* c, const TrackState* ts) {
+    c->randState = ts->randState;
+    c->clockCount = ts->clockCount;
+    c->loopCount = ts->loopCount;
+    c->octavePlayCount = ts->octavePlayCount;
+    c->step = ts->step;
+    c->walkPos = ts->walkPos;
+    c->lastStep = ts->lastStep;
+    c->brownianPos = ts->brownianPos;
+    c->shufflePos = ts->shufflePos;
+    memcpy(c->shuffleOrder, ts->shuffleOrder, sizeof(c->shuffleOrder));
+}
+
+static void applyCursor(TrackState* ts, const PlayCursor* c) {
+    ts->randState = c->randState;
+    ts->clockCount = c->clockCount;
+    ts->loopCount = c->loopCount;
+    ts->octavePlayCount = c->octavePlayCount;
+    ts->step = c->step;
+    ts->walkPos = c->walkPos;
+    ts->lastStep = c->lastStep;
+    ts->brownianPos = c->brownianPos;
+    ts->shufflePos = c->shufflePos;
+    memcpy(ts->shuffleOrder, c->shuffleOrder, sizeof(ts->shuffleOrder));
+}
+
+// Stage every track's playback state in one go, so tracks resume in step.
+// While a Resume is pending the stage already holds the loaded state, which
+// is what the next start will play from, so it is saved as is.
+static void stagePlayback(MidiLooperAlgorithm* alg) {
+    SaveStage* stage = alg->stage;
+    if (alg->dtc->resumePending) return;
+    for (int attempt = 0; attempt < SAVE_STAGE_RETRIES; attempt++) {
+        uint32_t seq = readWriteSeq(alg->dtc);
+        for (int t = 0; t < alg->numTracks; t++) {
+            copyCursor(&stage->cursor[t], &alg->trackStates[t]);
+            stage->divCounter[t] = alg->trackStates[t].divCounter;
+        }
+        stage->clockTicks = alg->dtc->clockTicks;
+        if (readWriteSeq(alg->dtc) == seq) return;
+    }
+    DEBUG_LOG("Save: playback staged while busy");
+}
+
+// Stage a track's playing slot, skip mask and settings
+static void stageTrack(MidiLooperAlgorithm* alg, int track) {
+    const TrackState* ts = &alg->trackStates[track];
+    SaveStage* stage = alg->stage;
+    for (int attempt = 0; attempt < SAVE_STAGE_RETRIES; attempt++) {
+        uint32_t seq = readWriteSeq(alg->dtc);
+        stage->pattern = ts->pattern;
+        memcpy(&stage->data, ts->data, sizeof(TrackData));
+        memcpy(stage->skipMask, ts->skipMask, sizeof(stage->skipMask));
+        memcpy(stage->settings, ts->settings, sizeof(stage->settings));
+        if (readWriteSeq(alg->dtc) == seq) return;
+    }
+    DEBUG_LOG("Save: track %d staged while busy", track);
+}
+
+// Stage one pattern slot's events (the rest of the stage is left alone)
+static void stageSlot(MidiLooperAlgorithm* alg, int track, int slot) {
+    const TrackData* data = patternSlot(alg->patterns, track, slot);
+    for (int attempt = 0; attempt < SAVE_STAGE_RETRIES; attempt++) {
+        uint32_t seq = readWriteSeq(alg->dtc);
+        memcpy(&alg->stage->data, data, sizeof(TrackData));
+        if (readWriteSeq(alg->dtc) == seq) return;
+    }
+    DEBUG_LOG("Save: track %d slot %d staged while busy", track, slot);
+}
+
 // ============================================================================
 // SERIALIZATION
 // ============================================================================
 
+// Events: array of steps, each step is array of event objects
+static void serialiseTrackEvents(_NT_jsonStream& stream, const TrackData* data) {
+    stream.openArray();
+    for (int s = 0; s < MAX_STEPS; s++) {
+        stream.openArray();
+        const StepEvents* evs = &data->steps[s];
+        for (int e = 0; e < evs->count && e < MAX_EVENTS_PER_STEP; e++) {
+            stream.openObject();
+            stream.addMemberName("n");
+            stream.addNumber((int)evs->events[e].note);
+            stream.addMemberName("v");
+            stream.addNumber((int)evs->events[e].velocity);
+            stream.addMemberName("d");
+            stream.addNumber((int)evs->events[e].duration);
+            stream.closeObject();
+        }
+        stream.closeArray();
+    }
+    stream.closeArray();
+}
+
+static bool hasEvents(const TrackData* data) {
+    for (int s = 0; s < MAX_STEPS; s++) {
+        if (data->steps[s].count > 0) return true;
+    }
+    return false;
+}
+
 void serialiseData(MidiLooperAlgorithm* alg, _NT_jsonStream& stream) {
     int numTracks = alg->numTracks;
 
@@ -61,47 +205,169 @@ void serialiseData(MidiLooperAlgorithm* alg, _NT_jsonStream& stream) {
     stream.addMemberName("numTracks");
     stream.addNumber(numTracks);
 
-    stream.addMemberName("tracks");
+    stream.addMemberName("settings");
     stream.openArray();
-    for (int t = 0; t < numTracks; t++) {
-        TrackState& ts = alg->trackStates[t];
+    for (int i = 0; i < kGlobalSettingCount; i++) {
+        stream.addNumber(getSetting(alg, i));
+    }
+    stream.closeArray();
 
-        stream.openObject();
+    stream.addMemberName("pitchMap");
+    stream.openArray();
+    for (int n = 0; n < 128; n++) {
+        stream.addNumber((int)alg->pitchMap[n]);
+    }
+    stream.closeArray();
 
-        // Events: array of steps, each step is array of event objects
-        stream.addMemberName("events");
+    stream.addMemberName("scenes");
+    stream.openArray();
+    for (int i = 0; i < NUM_SCENES; i++) {
+        const Scene& scene = alg->scenes->scenes[i];
+        if (!scene.stored) continue;
+
+        stream.openObject();
+        stream.addMemberName("slot");
+        stream.addNumber(i);
+        stream.addMemberName("params");
         stream.openArray();
-        for (int s = 0; s < MAX_STEPS; s++) {
+        for (int t = 0; t < numTracks; t++) {
+            stream.openArray();
+            for (int p = 0; p < PARAMS_PER_TRACK; p++) {
+                stream.addNumber((int)scene.params[t][p]);
+            }
+            stream.closeArray();
+        }
+        stream.closeArray();
+        stream.addMemberName("settings");
+        stream.openArray();
+        for (int t = 0; t < numTracks; t++) {
             stream.openArray();
-            StepEvents* evs = &ts.data.steps[s];
-            for (int e = 0; e < evs->count && e < MAX_EVENTS_PER_STEP; e++) {
-                stream.openObject();
-                stream.addMemberName("n");
-                stream.addNumber((int)evs->events[e].note);
-                stream.addMemberName("v");
-                stream.addNumber((int)evs->events[e].velocity);
-                stream.addMemberName("d");
-                stream.addNumber((int)evs->events[e].duration);
-                stream.closeObject();
+            for (int s = 0; s < kTrackSettingCount; s++) {
+                stream.addNumber((int)scene.settings[t][s]);
             }
             stream.closeArray();
         }
         stream.closeArray();
+        stream.closeObject();
+    }
+    stream.closeArray();
+
+    stream.addMemberName("ccMap");
+    stream.openArray();
+    for (int i = 0; i < NUM_CC_MAPPINGS; i++) {
+        const CcMapping& m = alg->ccMap->mappings[i];
+        if (!m.used) continue;
+
+        stream.openObject();
+        stream.addMemberName("ch");
+        stream.addNumber((int)m.channel);
+        stream.addMemberName("cc");
+        stream.addNumber((int)m.cc);
+        stream.addMemberName("type");
+        stream.addNumber((int)m.type);
+        stream.addMemberName("target");
+        stream.addNumber((int)m.target);
+        stream.addMemberName("min");
+        stream.addNumber((int)m.min);
+        stream.addMemberName("max");
+        stream.addNumber((int)m.max);
+        stream.closeObject();
+    }
+    stream.closeArray();
+
+    stagePlayback(alg);
+    stream.addMemberName("clockTicks");
+    stream.addNumber((int)alg->stage->clockTicks);
+
+    stream.addMemberName("tracks");
+    stream.openArray();
+    for (int t = 0; t < numTracks; t++) {
+        const TrackState& ts = alg->trackStates[t];
+        const SaveStage* stage = alg->stage;
+        const PlayCursor& cursor = stage->cursor[t];
+
+        // Everything but the idle slots comes from one consistent copy
+        stageTrack(alg, t);
+        int playing = stage->pattern;
+
+        stream.openObject();
+
+        // Playing pattern slot, then its events
+        stream.addMemberName("pattern");
+        stream.addNumber(playing);
+        stream.addMemberName("events");
+        serialiseTrackEvents(stream, &stage->data);
 
         // Shuffle order
         stream.addMemberName("shuffleOrder");
         stream.openArray();
         for (int s = 0; s < MAX_STEPS; s++) {
-            stream.addNumber((int)ts.shuffleOrder[s]);
+            stream.addNumber((int)cursor.shuffleOrder[s]);
         }
         stream.closeArray();
 
         // Per-track playback state
         stream.addMemberName("shufflePos");
-        stream.addNumber((int)ts.shufflePos);
+        stream.addNumber((int)cursor.shufflePos);
 
         stream.addMemberName("brownianPos");
-        stream.addNumber((int)ts.brownianPos);
+        stream.addNumber((int)cursor.brownianPos);
+
+        // Counters and PRNG, applied at the next start only with Resume
+        stream.addMemberName("clockCount");
+        stream.addNumber((int)cursor.clockCount);
+        stream.addMemberName("divCounter");
+        stream.addNumber((int)stage->divCounter[t]);
+        stream.addMemberName("loopCount");
+        stream.addNumber((int)cursor.loopCount);
+        stream.addMemberName("octaveCount");
+        stream.addNumber((int)cursor.octavePlayCount);
+        stream.addMemberName("step");
+        stream.addNumber((int)cursor.step);
+        stream.addMemberName("walkPos");
+        stream.addNumber((int)cursor.walkPos);
+        stream.addMemberName("lastStep");
+        stream.addNumber((int)cursor.lastStep);
+        stream.addMemberName("randState");
+        stream.addNumber((int)cursor.randState);
+
+        // Per-track settings
+        stream.addMemberName("settings");
+        stream.openArray();
+        for (int i = 0; i < kTrackSettingCount; i++) {
+            stream.addNumber((int)stage->settings[i]);
+        }
+        stream.closeArray();
+
+        // Skipped steps
+        stream.addMemberName("skip");
+        stream.openArray();
+        for (int s = 0; s < MAX_STEPS; s++) {
+            if ((stage->skipMask[s >> 5] >> (s & 31)) & 1) stream.addNumber(s);
+        }
+        stream.closeArray();
+
+        // The other pattern slots that hold anything (each staged in turn,
+        // which reuses the staging copy, so these come last)
+        stream.addMemberName("patterns");
+        stream.openArray();
+        for (int p = 0; p < NUM_PATTERNS; p++) {
+            if (p == playing) continue;
+            stageSlot(alg, t, p);
+            if (!hasEvents(&stage->data) && ts.slotProgram[p] == 0 && ts.slotBank[p] == 0) continue;
+
+            stream.openObject();
+            stream.addMemberName("slot");
+            stream.addNumber(p);
+            stream.addMemberName("program");
+            stream.addNumber((int)ts.slotProgram[p]);
+            stream.addMemberName("bank");
+            stream.addNumber((int)ts.slotBank[p]);
+            stream.addMemberName("events");
+            serialiseTrackEvents(stream, &stage->data);
+            stream.closeObject();
+        }
+        stream.closeArray();
 
         stream.closeObject();
     }
@@ -137,9 +403,9 @@ static bool parseEventObject(_NT_jsonParse& parse,
     return true;
 }
 
-// Parse the events array for one track: array of steps, each step is array of
-// event objects.
-static bool parseTrackEvents(_NT_jsonParse& parse, TrackState& ts) {
+// Parse the events array for one pattern slot: array of steps, each step is
+// array of event objects.
+static bool parseTrackEvents(_NT_jsonParse& parse, TrackData* data) {
     int numSteps;
     if (!parse.numberOfArrayElements(numSteps)) return false;
 
@@ -148,7 +414,7 @@ static bool parseTrackEvents(_NT_jsonParse& parse, TrackState& ts) {
         if (!parse.numberOfArrayElements(numEvents)) return false;
 
         if (s < MAX_STEPS)
-            ts.data.steps[s].count = 0;
+            data->steps[s].count = 0;
 
         for (int e = 0; e < numEvents; e++) {
             int note, vel, dur;
@@ -157,7 +423,7 @@ static bool parseTrackEvents(_NT_jsonParse& parse, TrackState& ts) {
             if (s < MAX_STEPS && e < MAX_EVENTS_PER_STEP &&
                 note >= 0 && note <= 127 && vel >= 0 && vel <= 127 &&
                 dur >= 1 && dur <= 65535) {
-                addEvent(&ts.data.steps[s], (uint8_t)note, (uint8_t)vel,
+                addEvent(&data->steps[s], (uint8_t)note, (uint8_t)vel,
                          (uint16_t)dur);
             }
         }
@@ -166,7 +432,7 @@ static bool parseTrackEvents(_NT_jsonParse& parse, TrackState& ts) {
 }
 
 // Parse a shuffle order array for one track.
-static bool parseShuffleOrderArray(_NT_jsonParse& parse, TrackState& ts) {
+static bool parseShuffleOrderArray(_NT_jsonParse& parse, PlayCursor& cursor) {
     int numSteps;
     if (!parse.numberOfArrayElements(numSteps)) return false;
 
@@ -174,34 +440,322 @@ static bool parseShuffleOrderArray(_NT_jsonParse& parse, TrackState& ts) {
         int val;
         if (!parse.number(val)) return false;
         if (s < MAX_STEPS)
-            ts.shuffleOrder[s] = (uint8_t)clampParam(val, 1, MAX_STEPS);
+            cursor.shuffleOrder[s] = (uint8_t)clampParam(val, 1, MAX_STEPS);
+    }
+    return true;
+}
+
+// Parse a per-track settings array (kTrkSet* order).
+static bool parseTrackSettingsArray(_NT_jsonParse& parse, MidiLooperAlgorithm* alg, int track) {
+    int numSettings;
+    if (!parse.numberOfArrayElements(numSettings)) return false;
+
+    for (int i = 0; i < numSettings; i++) {
+        int val;
+        if (!parse.number(val)) return false;
+        setTrackSetting(alg, track, i, val);
+    }
+    return true;
+}
+
+// Parse a skipped steps array (0-based step numbers) for one track.
+static bool parseSkipArray(_NT_jsonParse& parse, TrackState& ts) {
+    int numSteps;
+    if (!parse.numberOfArrayElements(numSteps)) return false;
+
+    memset(ts.skipMask, 0, sizeof(ts.skipMask));
+    ts.stepMapDirty = true;
+    for (int i = 0; i < numSteps; i++) {
+        int step;
+        if (!parse.number(step)) return false;
+        if (step >= 0 && step < MAX_STEPS)
+            setStepSkipped(&ts, step, true);
+    }
+    return true;
+}
+
+static void clearTrackData(TrackData* data) {
+    for (int s = 0; s < MAX_STEPS; s++) {
+        data->steps[s].count = 0;
+    }
+}
+
+// Parse one stored pattern slot: slot, program, bank, events, in any order.
+// The events are read into the save stage and copied once the slot is known.
+static bool parsePatternObject(_NT_jsonParse& parse, MidiLooperAlgorithm* alg, int track) {
+    TrackState& ts = alg->trackStates[track];
+    TrackData* events = &alg->stage->data;
+    clearTrackData(events);
+
+    int numMembers;
+    if (!parse.numberOfObjectMembers(numMembers)) return false;
+
+    int slot = -1, program = 0, bank = 0;
+    for (int i = 0; i < numMembers; i++) {
+        if (parse.matchName("slot")) {
+            if (!parse.number(slot)) return false;
+        } else if (parse.matchName("program")) {
+            if (!parse.number(program)) return false;
+        } else if (parse.matchName("bank")) {
+            if (!parse.number(bank)) return false;
+        } else if (parse.matchName("events")) {
+            if (!parseTrackEvents(parse, events)) return false;
+        } else {
+            if (!parse.skipMember()) return false;
+        }
+    }
+
+    if (slot >= 0 && slot < NUM_PATTERNS) {
+        ts.slotProgram[slot] = (int16_t)clampTrackSetting(kTrkSetProgram, program);
+        ts.slotBank[slot] = (int16_t)clampTrackSetting(kTrkSetBank, bank);
+        memcpy(patternSlot(alg->patterns, track, slot), events, sizeof(TrackData));
     }
     return true;
 }
 
-// Parse one track object: events, shuffleOrder, shufflePos, brownianPos,
-// plus skip any unknown members.
-static bool parseTrackObject(_NT_jsonParse& parse, TrackState& ts) {
+static bool parsePatternsArray(_NT_jsonParse& parse, MidiLooperAlgorithm* alg, int track) {
+    int numPatterns;
+    if (!parse.numberOfArrayElements(numPatterns)) return false;
+
+    for (int i = 0; i < numPatterns; i++) {
+        if (!parsePatternObject(parse, alg, track)) return false;
+    }
+    return true;
+}
+
+// Parse one track object: pattern, events, patterns, shuffleOrder,
+// shufflePos, brownianPos, settings, skip, plus skip any unknown members.
+// Members may come in any order: the playing slot's events are held in the
+// save stage and written over its slot at the end, so a "patterns" entry for
+// that slot never wins over them. Pattern slots missing from the preset are
+// left empty. The playback counters
+// and PRNG go to the staged cursor; whether the next start uses them is
+// decided once the whole preset (and its Resume setting) has been read.
+static bool parseTrackObject(_NT_jsonParse& parse, MidiLooperAlgorithm* alg, int track) {
+    TrackState& ts = alg->trackStates[track];
+    PlayCursor& cursor = alg->stage->cursor[track];
+    TrackData* events = &alg->stage->loadData;
+    bool hasPlayingEvents = false;
+    for (int p = 0; p < NUM_PATTERNS; p++) {
+        clearTrackData(patternSlot(alg->patterns, track, p));
+    }
+    clearTrackData(events);
+    ts.data = patternSlot(alg->patterns, track, 0);
+    ts.pattern = 0;
+    ts.launchSlot = LAUNCH_NONE;
+    memset(ts.slotProgram, 0, sizeof(ts.slotProgram));
+    memset(ts.slotBank, 0, sizeof(ts.slotBank));
+    alg->dtc->launchBarMask &= (uint8_t)~(1u << track);
+    markTrackEdited(&ts);
+
     int numMembers;
     if (!parse.numberOfObjectMembers(numMembers)) return false;
 
     for (int i = 0; i < numMembers; i++) {
-        if (parse.matchName("events")) {
-            if (!parseTrackEvents(parse, ts)) return false;
+        if (parse.matchName("pattern")) {
+            int val;
+            if (!parse.number(val)) return false;
+            ts.pattern = (uint8_t)clampParam(val, 0, NUM_PATTERNS - 1);
+            ts.data = patternSlot(alg->patterns, track, ts.pattern);
+        } else if (parse.matchName("events")) {
+            if (!parseTrackEvents(parse, events)) return false;
+            hasPlayingEvents = true;
+        } else if (parse.matchName("patterns")) {
+            if (!parsePatternsArray(parse, alg, track)) return false;
         } else if (parse.matchName("shuffleOrder")) {
-            if (!parseShuffleOrderArray(parse, ts)) return false;
+            if (!parseShuffleOrderArray(parse, cursor)) return false;
         } else if (parse.matchName("shufflePos")) {
             int val;
             if (!parse.number(val)) return false;
-            ts.shufflePos = (uint8_t)clampParam(val, 1, MAX_STEPS);
+            cursor.shufflePos = (uint8_t)clampParam(val, 1, MAX_STEPS);
         } else if (parse.matchName("brownianPos")) {
             int val;
             if (!parse.number(val)) return false;
-            ts.brownianPos = (uint8_t)clampParam(val, 1, MAX_STEPS);
+            cursor.brownianPos = (uint8_t)clampParam(val, 1, MAX_STEPS);
+        } else if (parse.matchName("clockCount")) {
+            int val;
+            if (!parse.number(val)) return false;
+            cursor.clockCount = (uint16_t)clampParam(val, 0, 65535);
+        } else if (parse.matchName("divCounter")) {
+            int val;
+            if (!parse.number(val)) return false;
+            alg->stage->divCounter[track] = (uint16_t)clampParam(val, 0, 65535);
+        } else if (parse.matchName("loopCount")) {
+            int val;
+            if (!parse.number(val)) return false;
+            cursor.loopCount = (uint16_t)clampParam(val, 0, 65535);
+        } else if (parse.matchName("octaveCount")) {
+            int val;
+            if (!parse.number(val)) return false;
+            cursor.octavePlayCount = (uint16_t)clampParam(val, 0, 65535);
+        } else if (parse.matchName("step")) {
+            int val;
+            if (!parse.number(val)) return false;
+            cursor.step = (uint8_t)clampParam(val, 0, MAX_STEPS);
+        } else if (parse.matchName("walkPos")) {
+            int val;
+            if (!parse.number(val)) return false;
+            cursor.walkPos = (uint8_t)clampParam(val, 0, MAX_STEPS);
+        } else if (parse.matchName("lastStep")) {
+            int val;
+            if (!parse.number(val)) return false;
+            cursor.lastStep = (uint8_t)clampParam(val, 1, MAX_STEPS);
+        } else if (parse.matchName("randState")) {
+            int val;
+            if (!parse.number(val)) return false;
+            cursor.randState = (uint32_t)val;
+        } else if (parse.matchName("settings")) {
+            if (!parseTrackSettingsArray(parse, alg, track)) return false;
+        } else if (parse.matchName("skip")) {
+            if (!parseSkipArray(parse, ts)) return false;
         } else {
             if (!parse.skipMember()) return false;
         }
     }
+    if (hasPlayingEvents) memcpy(ts.data, events, sizeof(TrackData));
+    return true;
+}
+
+// Parse the settings array (kSet* order). Extra entries from newer versions
+// are ignored; missing ones keep their current values.
+static bool parseSettingsArray(_NT_jsonParse& parse, MidiLooperAlgorithm* alg) {
+    int numSettings;
+    if (!parse.numberOfArrayElements(numSettings)) return false;
+
+    for (int i = 0; i < numSettings; i++) {
+        int val;
+        if (!parse.number(val)) return false;
+        // Indices past the global settings would reach the Rec Track's settings
+        if (i < kGlobalSettingCount) setSetting(alg, i, val);
+    }
+    alg->dtc->settingSyncPending = true;
+    return true;
+}
+
+// Parse the Note Map scale table (up to 128 entries, missing ones map to themselves).
+static bool parsePitchMapArray(_NT_jsonParse& parse, MidiLooperAlgorithm* alg) {
+    int numNotes;
+    if (!parse.numberOfArrayElements(numNotes)) return false;
+
+    for (int n = 0; n < 128; n++) {
+        alg->pitchMap[n] = (uint8_t)n;
+    }
+    for (int n = 0; n < numNotes; n++) {
+        int val;
+        if (!parse.number(val)) return false;
+        if (n < 128)
+            alg->pitchMap[n] = (uint8_t)clampParam(val, 0, 127);
+    }
+    updateScaleLut(alg);
+    return true;
+}
+
+// Parse a per-track array of arrays ([[...], ...]) into rows of `width`
+// values. Rows beyond numTracks and values beyond width are read and dropped.
+static bool parseSceneRows(_NT_jsonParse& parse, int16_t* rows, int width, int numTracks) {
+    int numRows;
+    if (!parse.numberOfArrayElements(numRows)) return false;
+
+    for (int t = 0; t < numRows; t++) {
+        int numValues;
+        if (!parse.numberOfArrayElements(numValues)) return false;
+        for (int i = 0; i < numValues; i++) {
+            int val;
+            if (!parse.number(val)) return false;
+            if (t < numTracks && i < width)
+                rows[t * width + i] = (int16_t)clamp(val, -32768, 32767);
+        }
+    }
+    return true;
+}
+
+// Parse one scene object: slot, params, settings. Entries missing from the
+// preset take the current values.
+static bool parseSceneObject(_NT_jsonParse& parse, MidiLooperAlgorithm* alg) {
+    Scene scene;
+    for (int t = 0; t < alg->numTracks; t++) {
+        memcpy(scene.params[t], &alg->v[trackParam(t, 0)], sizeof(scene.params[t]));
+        memcpy(scene.settings[t], alg->trackStates[t].settings, sizeof(scene.settings[t]));
+    }
+    int slot = -1;
+
+    int numMembers;
+    if (!parse.numberOfObjectMembers(numMembers)) return false;
+
+    for (int i = 0; i < numMembers; i++) {
+        if (parse.matchName("slot")) {
+            if (!parse.number(slot)) return false;
+        } else if (parse.matchName("params")) {
+            if (!parseSceneRows(parse, &scene.params[0][0], PARAMS_PER_TRACK, alg->numTracks)) return false;
+        } else if (parse.matchName("settings")) {
+            if (!parseSceneRows(parse, &scene.settings[0][0], kTrackSettingCount, alg->numTracks)) return false;
+        } else {
+            if (!parse.skipMember()) return false;
+        }
+    }
+
+    if (slot >= 0 && slot < NUM_SCENES) {
+        alg->scenes->scenes[slot] = scene;
+        validateScene(alg, slot);
+    }
+    return true;
+}
+
+static bool parseScenesArray(_NT_jsonParse& parse, MidiLooperAlgorithm* alg) {
+    int numScenes;
+    if (!parse.numberOfArrayElements(numScenes)) return false;
+
+    initScenes(alg->scenes);
+    for (int i = 0; i < numScenes; i++) {
+        if (!parseSceneObject(parse, alg)) return false;
+    }
+    return true;
+}
+
+// Parse one CC mapping. Mappings whose target doesn't exist in this
+// instance (fewer tracks, unknown action) are dropped.
+static bool parseCcMappingObject(_NT_jsonParse& parse, MidiLooperAlgorithm* alg) {
+    int channel = -1, cc = -1, type = CC_TARGET_PARAM, target = -1, min = 0, max = 0;
+
+    int numMembers;
+    if (!parse.numberOfObjectMembers(numMembers)) return false;
+
+    for (int i = 0; i < numMembers; i++) {
+        if (parse.matchName("ch")) {
+            if (!parse.number(channel)) return false;
+        } else if (parse.matchName("cc")) {
+            if (!parse.number(cc)) return false;
+        } else if (parse.matchName("type")) {
+            if (!parse.number(type)) return false;
+        } else if (parse.matchName("target")) {
+            if (!parse.number(target)) return false;
+        } else if (parse.matchName("min")) {
+            if (!parse.number(min)) return false;
+        } else if (parse.matchName("max")) {
+            if (!parse.number(max)) return false;
+        } else {
+            if (!parse.skipMember()) return false;
+        }
+    }
+
+    if (type == CC_TARGET_PARAM && target >= 0 && target < GLOBAL_PARAMS + PARAMS_PER_TRACK * alg->numTracks) {
+        const _NT_parameter& def = alg->parameters[target];
+        addCcMapping(alg->ccMap, channel, cc, type, target, clamp(min, (int)def.min, (int)def.max),
+                     clamp(max, (int)def.min, (int)def.max));
+    } else if (type == CC_TARGET_ACTION && target >= 0 && target <= alg->parameters[kParamAction].max) {
+        addCcMapping(alg->ccMap, channel, cc, type, target, 0, 1);
+    }
+    return true;
+}
+
+static bool parseCcMapArray(_NT_jsonParse& parse, MidiLooperAlgorithm* alg) {
+    int numMappings;
+    if (!parse.numberOfArrayElements(numMappings)) return false;
+
+    initCcMap(alg->ccMap);
+    for (int i = 0; i < numMappings; i++) {
+        if (!parseCcMappingObject(parse, alg)) return false;
+    }
     return true;
 }
 
@@ -220,8 +774,42 @@ static bool skipTrackObject(_NT_jsonParse& parse) {
 // DESERIALIZATION
 // ============================================================================
 
+// Playback state a start from scratch would give, for tracks the preset leaves out
+static void resetLoadedPlayback(MidiLooperAlgorithm* alg) {
+    SaveStage* stage = alg->stage;
+    for (int t = 0; t < alg->numTracks; t++) {
+        PlayCursor* c = &stage->cursor[t];
+        c->randState = alg->trackStates[t].randState;
+        c->clockCount = 0;
+        c->loopCount = 0;
+        c->octavePlayCount = 0;
+        c->step = 0;
+        c->walkPos = 0;
+        c->lastStep = 1;
+        c->brownianPos = 1;
+        c->shufflePos = 1;
+        for (int s = 0; s < MAX_STEPS; s++) {
+            c->shuffleOrder[s] = (uint8_t)(s + 1);
+        }
+        stage->divCounter[t] = 0;
+    }
+    stage->clockTicks = 0;
+}
+
+// Resume: the transport starts from the loaded playback state (handleTransportStart)
+void applyLoadedPlayback(MidiLooperAlgorithm* alg) {
+    const SaveStage* stage = alg->stage;
+    for (int t = 0; t < alg->numTracks; t++) {
+        applyCursor(&alg->trackStates[t], &stage->cursor[t]);
+        alg->trackStates[t].divCounter = stage->divCounter[t];
+    }
+    alg->dtc->clockTicks = stage->clockTicks;
+}
+
 bool deserialiseData(MidiLooperAlgorithm* alg, _NT_jsonParse& parse) {
     int maxTracks = alg->numTracks;
+    alg->dtc->resumePending = false;
+    resetLoadedPlayback(alg);
 
     int numMembers;
     if (!parse.numberOfObjectMembers(numMembers)) return false;
@@ -235,13 +823,25 @@ bool deserialiseData(MidiLooperAlgorithm* alg, _NT_jsonParse& parse) {
             int savedTracks;
             if (!parse.number(savedTracks)) return false;
             (void)savedTracks;
+        } else if (parse.matchName("settings")) {
+            if (!parseSettingsArray(parse, alg)) return false;
+        } else if (parse.matchName("pitchMap")) {
+            if (!parsePitchMapArray(parse, alg)) return false;
+        } else if (parse.matchName("scenes")) {
+            if (!parseScenesArray(parse, alg)) return false;
+        } else if (parse.matchName("ccMap")) {
+            if (!parseCcMapArray(parse, alg)) return false;
+        } else if (parse.matchName("clockTicks")) {
+            int val;
+            if (!parse.number(val)) return false;
+            alg->stage->clockTicks = (uint32_t)val;
         } else if (parse.matchName("tracks")) {
             int fileTracks;
             if (!parse.numberOfArrayElements(fileTracks)) return false;
 
             for (int t = 0; t < fileTracks; t++) {
                 if (t < maxTracks) {
-                    if (!parseTrackObject(parse, alg->trackStates[t]))
+                    if (!parseTrackObject(parse, alg, t))
                         return false;
                 } else {
                     if (!skipTrackObject(parse)) return false;
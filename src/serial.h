@@ -10,3 +10,4 @@
 
 void serialiseData(MidiLooperAlgorithm* alg, _NT_jsonStream& stream);
 bool deserialiseData(MidiLooperAlgorithm* alg, _NT_jsonParse& parse);
+void applyLoadedPlayback(MidiLooperAlgorithm* alg);
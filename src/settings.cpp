@@ -0,0 +1,167 @@
+#include "settings.h"
+#include "math.h"
+#include "playback.h"
+#include "quantize.h"
+#include "scales.h"
+
+// ============================================================================
+// SETTING DEFINITIONS
+// ============================================================================
+
+struct SettingDef {
+    int16_t min;
+    int16_t max;
+    int16_t def;
+};
+
+// Indexed by kSet* (order must match settingStrings in params.h)
+static const SettingDef globalSettingDefs[] = {
+    {1, MAX_STEPS, 1},                        // kSetRangeStart
+    {0, MAX_STEPS, 0},                        // kSetRangeEnd
+    {0, MAX_TRACKS, 0},                       // kSetDestTrack
+    {0, MAX_STEPS, 0},                        // kSetDestStep
+    {EDIT_QUANT_NOW, EDIT_QUANT_LOOP, EDIT_QUANT_NOW}, // kSetEditQuant
+    {0, SCALE_MASK_CHROMATIC, SCALE_MASK_CHROMATIC},   // kSetUserScale1
+    {0, SCALE_MASK_CHROMATIC, SCALE_MASK_CHROMATIC},   // kSetUserScale2
+    {0, SCALE_MASK_CHROMATIC, SCALE_MASK_CHROMATIC},   // kSetUserScale3
+    {0, SCALE_MASK_CHROMATIC, SCALE_MASK_CHROMATIC},   // kSetUserScale4
+    {0, 8, 0},                                // kSetCountIn
+    {METRO_OFF, METRO_ON, METRO_COUNT_IN},    // kSetMetronome
+    {0, 16, 0},                               // kSetMetroChannel
+    {0, 127, 76},                             // kSetMetroNote
+    {1, 8, 1},                                // kSetFreezeLoops
+    {1, NUM_SCENES, 1},                       // kSetScene
+    {SCENE_QUANT_NOW, SCENE_QUANT_LOOP, SCENE_QUANT_BAR}, // kSetSceneQuant
+    {0, (1 << MAX_TRACKS) - 1, 0},            // kSetMute
+    {0, (1 << MAX_TRACKS) - 1, 0},            // kSetSolo
+    {MUTE_QUANT_NOW, MUTE_QUANT_LOOP, MUTE_QUANT_BAR}, // kSetMuteQuant
+    {0, 1, 0},                                // kSetMuteRing
+    {CC_LEARN_OFF, CC_LEARN_FORGET, CC_LEARN_OFF}, // kSetCcLearn
+    {0, 16, 0},                               // kSetLaunchCh
+    {0, 127, 36},                             // kSetLaunchNote
+    {LAUNCH_QUANT_WRAP, LAUNCH_QUANT_BAR, LAUNCH_QUANT_WRAP}, // kSetLaunchQuant
+    {0, 500, 10},                             // kSetProgLead
+    {1, 127, 100},                            // kSetCvVelocity
+    {0, 1, 0},                                // kSetResume
+};
+
+// Indexed by kTrkSet*
+static const SettingDef trackSettingDefs[] = {
+    {0, MAX_TRACKS, 0},                       // kTrkSetFollow
+    {-(MAX_STEPS - 1), MAX_STEPS - 1, 0},     // kTrkSetFollowOfs
+    {0, 1, 0},                                // kTrkSetLegato
+    {1, MAX_STEPS, 1},                        // kTrkSetLoopStart
+    {0, 1, 1},                                // kTrkSetRepeat
+    {0, MAX_TRACKS, 0},                       // kTrkSetDepTrack
+    {DEP_PLAYED, DEP_NOT_PLAYED, DEP_PLAYED}, // kTrkSetDepMode
+    {MOD_OFF, MOD_CHANCE, MOD_OFF},           // kTrkSetModType
+    {0, (1 << MAX_TRACKS) - 1, 0},            // kTrkSetModDest
+    {0, 127, 20},                             // kTrkSetModAmount
+    {0, 128, 0},                              // kTrkSetProgram
+    {0, 4095, 0},                             // kTrkSetBank
+};
+
+static_assert(sizeof(globalSettingDefs) / sizeof(globalSettingDefs[0]) == kGlobalSettingCount,
+              "Setting definition table size mismatch - update table when adding settings");
+static_assert(sizeof(trackSettingDefs) / sizeof(trackSettingDefs[0]) == kTrackSettingCount,
+              "Track setting definition table size mismatch - update table when adding settings");
+
+// ============================================================================
+// SETTING ACCESS
+// ============================================================================
+
+// Per-track settings address the Rec Track
+static int settingTrack(MidiLooperAlgorithm* alg) {
+    return clampParam(alg->v[kParamRecTrack], 0, alg->numTracks - 1);
+}
+
+int getSetting(MidiLooperAlgorithm* alg, int index) {
+    if (index < 0 || index >= TOTAL_SETTINGS) return 0;
+    if (index < kGlobalSettingCount) return alg->dtc->settings[index];
+    return getTrackSetting(alg, settingTrack(alg), index - kGlobalSettingCount);
+}
+
+void setSetting(MidiLooperAlgorithm* alg, int index, int value) {
+    if (index < 0 || index >= TOTAL_SETTINGS) return;
+    if (index < kGlobalSettingCount) {
+        const SettingDef& def = globalSettingDefs[index];
+        alg->dtc->settings[index] = (int16_t)clamp(value, def.min, def.max);
+        if (index >= kSetUserScale1 && index <= kSetUserScale4) {
+            updateScaleLut(alg);
+        }
+        return;
+    }
+    setTrackSetting(alg, settingTrack(alg), index - kGlobalSettingCount, value);
+}
+
+// Clamp a value to a per-track setting's range (index must be valid)
+int clampTrackSetting(int index, int value) {
+    const SettingDef& def = trackSettingDefs[index];
+    return clamp(value, def.min, def.max);
+}
+
+int getTrackSetting(MidiLooperAlgorithm* alg, int track, int index) {
+    if (index < 0 || index >= kTrackSettingCount) return 0;
+    return alg->trackStates[track].settings[index];
+}
+
+void setTrackSetting(MidiLooperAlgorithm* alg, int track, int index, int value) {
+    if (index < 0 || index >= kTrackSettingCount) return;
+    alg->trackStates[track].settings[index] = (int16_t)clampTrackSetting(index, value);
+
+    if (index == kTrkSetFollow || index == kTrkSetDepTrack || index == kTrkSetModType || index == kTrkSetModDest) {
+        buildTrackOrder(alg);
+    }
+}
+
+void resetSettings(MidiLooperAlgorithm* alg) {
+    for (int i = 0; i < kGlobalSettingCount; i++) {
+        alg->dtc->settings[i] = globalSettingDefs[i].def;
+    }
+    for (int t = 0; t < alg->numTracks; t++) {
+        for (int i = 0; i < kTrackSettingCount; i++) {
+            alg->trackStates[t].settings[i] = trackSettingDefs[i].def;
+        }
+    }
+    buildTrackOrder(alg);
+    alg->dtc->settingSyncPending = true;
+}
+
+// ============================================================================
+// VALUE PARAMETER SYNC
+// ============================================================================
+
+// Store the Value parameter into the selected setting.
+// Ignored while a push is pending, so a stale Value never lands in a newly
+// selected setting. Out-of-range values are clamped and pushed back.
+void handleSettingValueChanged(MidiLooperAlgorithm* alg) {
+    MidiLooper_DTC* dtc = alg->dtc;
+    if (dtc->settingSyncPending) return;
+
+    int index = alg->v[kParamSetting];
+    int value = alg->v[kParamSettingValue];
+    setSetting(alg, index, value);
+    if (getSetting(alg, index) != value) {
+        dtc->settingSyncPending = true;
+    }
+}
+
+// Push the selected setting's value to the Value parameter (called from step())
+void syncSettingValue(MidiLooperAlgorithm* alg) {
+    MidiLooper_DTC* dtc = alg->dtc;
+    if (!dtc->settingSyncPending) return;
+    dtc->settingSyncPending = false;
+
+    int value = getSetting(alg, alg->v[kParamSetting]);
+    if (alg->v[kParamSettingValue] != value) {
+        setParameterValue(alg, kParamSettingValue, value);
+    }
+}
+
+// ============================================================================
+// PARAMETER WRITE-BACK
+// ============================================================================
+
+void setParameterValue(MidiLooperAlgorithm* alg, int param, int value) {
+    NT_setParameterFromAudio(NT_algorithmIndex(alg), param + NT_parameterOffset(), (int16_t)value);
+}
@@ -0,0 +1,23 @@
+/*
+ * MIDI Looper - Engine Settings
+ * Setting/Value parameter pair and parameter write-back
+ */
+
+#pragma once
+
+#include "types.h"
+
+// Setting access (index is the Setting parameter value; track settings apply to the Rec Track)
+int getSetting(MidiLooperAlgorithm* alg, int index);
+void setSetting(MidiLooperAlgorithm* alg, int index, int value);
+int getTrackSetting(MidiLooperAlgorithm* alg, int track, int index);
+void setTrackSetting(MidiLooperAlgorithm* alg, int track, int index, int value);
+int clampTrackSetting(int index, int value);
+void resetSettings(MidiLooperAlgorithm* alg);
+
+// Value parameter sync
+void handleSettingValueChanged(MidiLooperAlgorithm* alg);
+void syncSettingValue(MidiLooperAlgorithm* alg);
+
+// Write a parameter from the audio thread (as if turned on the module)
+void setParameterValue(MidiLooperAlgorithm* alg, int param, int value);
@@ -17,6 +17,7 @@
 static constexpr uint8_t kMidiNoteOff = 0x80;
 static constexpr uint8_t kMidiNoteOn = 0x90;
 static constexpr uint8_t kMidiCC = 0xB0;
+static constexpr uint8_t kMidiProgramChange = 0xC0;
 
 // Transport state machine
 enum TransportState {
@@ -29,7 +30,8 @@ enum RecordState {
     REC_IDLE = 0,         // Not recording
     REC_LIVE,             // Live recording (transport must be RUNNING)
     REC_STEP,             // Step recording (transport-independent)
-    REC_LIVE_PENDING      // Record ON + live mode, waiting for transport
+    REC_LIVE_PENDING,     // Record ON + live mode, waiting for transport
+    REC_COUNT_IN          // Transport running, counting in before live recording
 };
 
 // ============================================================================
@@ -55,7 +57,12 @@ enum RecordState {
 //
 //   REC_LIVE_PENDING ──Record OFF─────────► REC_IDLE
 //   REC_LIVE_PENDING ──Mode to Step───────► REC_STEP
-//   REC_LIVE_PENDING ──Transport starts───► REC_LIVE
+//   REC_LIVE_PENDING ──Transport starts───► REC_LIVE (or REC_COUNT_IN if Count-In > 0)
+//
+//   REC_COUNT_IN ──Count-in ends──────────► REC_LIVE
+//   REC_COUNT_IN ──Transport stop─────────► REC_LIVE_PENDING
+//   REC_COUNT_IN ──Record OFF─────────────► REC_IDLE
+//   REC_COUNT_IN ──Mode to Step───────────► REC_STEP
 //
 
 // Transport state query helper
@@ -89,6 +96,7 @@ static inline TransportState transportTransition_Stop(TransportState current) {
 }
 
 // Trig condition constants
+static constexpr int COND_ALWAYS = 0;
 static constexpr int COND_FIXED = 75;
 
 // Direction constants (0-indexed to match parameter values)
@@ -113,12 +121,94 @@ static constexpr int GEN_MODE_NEW = 0;
 static constexpr int GEN_MODE_REORDER = 1;
 static constexpr int GEN_MODE_REPITCH = 2;
 static constexpr int GEN_MODE_INVERT = 3;
+static constexpr int GEN_MODE_CHORD = 4;
+static constexpr int GEN_MODE_CHORD_VL = 5;
 
 // Recording mode constants
 static constexpr int REC_MODE_REPLACE = 0;
 static constexpr int REC_MODE_OVERDUB = 1;
 static constexpr int REC_MODE_STEP    = 2;
 
+// Action constants (index into the Action parameter)
+static constexpr int ACTION_COPY = 0;
+static constexpr int ACTION_PASTE = 1;
+static constexpr int ACTION_DUPLICATE = 2;
+static constexpr int ACTION_DOUBLE = 3;
+static constexpr int ACTION_COPY_TRACK = 4;
+static constexpr int ACTION_DETECT_KEY = 5;
+static constexpr int ACTION_APPLY_KEY = 6;
+static constexpr int ACTION_CAPTURE_1 = 7;
+static constexpr int ACTION_CAPTURE_2 = 8;
+static constexpr int ACTION_CAPTURE_4 = 9;
+static constexpr int ACTION_FREEZE = 10;
+static constexpr int ACTION_SCENE_STORE = 11;
+static constexpr int ACTION_SCENE_RECALL = 12;
+static constexpr int ACTION_SKIP = 13;
+static constexpr int ACTION_UNSKIP = 14;
+
+// Cross-track trig dependency (Dep Mode setting)
+static constexpr int DEP_PLAYED = 0;     // Play only if the Dep Track played on this clock
+static constexpr int DEP_NOT_PLAYED = 1; // Play only if it didn't
+
+// MIDI CC learn (CC Learn setting)
+static constexpr int CC_LEARN_OFF = 0;
+static constexpr int CC_LEARN_BIND = 1;   // Next CC maps to the last touched parameter (or selected action)
+static constexpr int CC_LEARN_FORGET = 2; // Next CC is unmapped
+
+// CC mapping targets
+static constexpr uint8_t CC_TARGET_PARAM = 0;  // Value scaled into min..max
+static constexpr uint8_t CC_TARGET_ACTION = 1; // Runs when the value crosses CC_ACTION_THRESHOLD upwards
+
+// Pattern launch timing (Launch Qnt setting)
+static constexpr int LAUNCH_QUANT_WRAP = 0; // At the launched track's next loop wrap
+static constexpr int LAUNCH_QUANT_BAR = 1;  // On the clock that starts the Rec Track's next bar
+static constexpr uint8_t LAUNCH_NONE = 0xFF;
+
+static constexpr uint8_t CV_NOTE_NONE = 0xFF;
+
+// Deferrable work, drained in this (priority) order while the block's cycle
+// budget lasts. Note-offs, clocks and input are never deferred.
+enum {
+    kDeferGenerate,     // Generate requested on a track
+    kDeferCapture,      // Capture commit slice
+    kDeferFreeze,       // Freeze render slice
+    kDeferRanks,        // Play Density rank rebuild
+
+    kDeferCount
+};
+
+// Cross-track modulation (Mod Type setting)
+static constexpr int MOD_OFF = 0;
+static constexpr int MOD_ACCENT = 1;    // Steps with events add Mod Amount to the velocity
+static constexpr int MOD_TRANSPOSE = 2; // First note of a step, relative to C4, transposes until the next
+static constexpr int MOD_CHANCE = 3;    // Step velocity sets the chance (0-100%) that notes play
+
+// Rec Track spans that quantized changes wait for (see recTrackSpanEnded)
+static constexpr int SPAN_BEAT = 1; // Rec Division grid step
+static constexpr int SPAN_BAR = 2;  // BEATS_PER_BAR beats
+static constexpr int SPAN_LOOP = 3; // Loop length
+
+// Scene recall timing (Scene Quant setting)
+static constexpr int SCENE_QUANT_NOW = 0;
+static constexpr int SCENE_QUANT_BAR = 1;  // Next bar of the Rec Track (BEATS_PER_BAR beats)
+static constexpr int SCENE_QUANT_LOOP = 2; // Next loop of the Rec Track
+
+// Mute/solo timing (Mute Quant setting; values match SPAN_*)
+static constexpr int MUTE_QUANT_NOW = 0;
+static constexpr int MUTE_QUANT_BEAT = SPAN_BEAT;
+static constexpr int MUTE_QUANT_BAR = SPAN_BAR;
+static constexpr int MUTE_QUANT_LOOP = SPAN_LOOP;
+
+// Metronome modes (Metronome setting)
+static constexpr int METRO_OFF = 0;
+static constexpr int METRO_COUNT_IN = 1; // Count-in only
+static constexpr int METRO_RECORD = 2;   // Count-in and while live recording
+static constexpr int METRO_ON = 3;       // Whenever the transport runs
+
+// Edit timing (Edit Quant setting)
+static constexpr int EDIT_QUANT_NOW = 0;
+static constexpr int EDIT_QUANT_LOOP = 1;
+
 // Quantize values mapping (index 0-4 -> actual division)
 static constexpr int QUANTIZE_VALUES[] = { 1, 2, 4, 8, 16 };
 
@@ -138,6 +228,7 @@ static constexpr int UI_OUTPUT_LABEL_X = 162;
 static constexpr int UI_OUTPUT_BAR_X = 176;
 static constexpr int UI_OUTPUT_BAR_SPACE = 10;
 static constexpr int UI_LABEL_Y = 20;
+static constexpr int UI_KEY_X = 44;
 static constexpr int UI_TRACK_WIDTH = 65;
 static constexpr int UI_TRACK_BOX_WIDTH = 56;
 
@@ -167,7 +258,7 @@ static constexpr float GATE_THRESHOLD_LOW = 0.5f;
 // PARAMETER ENUMS
 // ============================================================================
 
-// Global parameter indices (0-10)
+// Global parameter indices (0-32)
 enum {
     kParamRunInput = 0,    // CV input bus selector for run/gate
     kParamClockInput,      // CV input bus selector for clock/trigger
@@ -192,8 +283,18 @@ enum {
     kParamGenTies,
     kParamGenGateRand,
     kParamFill,
-
-    kGlobalParamCount  // = 23
+    kParamAction,
+    kParamExecute,
+    kParamSetting,
+    kParamSettingValue,
+    kParamMetroOutput,     // CV output bus for metronome clicks
+    kParamFeedback,        // Overdub velocity kept per pass (100 = no decay)
+    kParamBeatRepeat,      // Momentary repeat of the last 1/2^n of the loop (0 = off)
+    kParamPlayDensity,     // Events play if their importance rank is below this (100 = all)
+    kParamPitchInput,      // CV input bus for recorded pitch (1 V/oct)
+    kParamCvGateInput,     // CV input bus for recorded gates
+
+    kGlobalParamCount  // = 33
 };
 
 // Per-track parameter offsets (0-25)
@@ -234,6 +335,64 @@ static_assert(PARAMS_PER_TRACK == kTrackParamCount,
 static_assert(GLOBAL_PARAMS == kGlobalParamCount,
               "GLOBAL_PARAMS must match kGlobalParamCount enum");
 
+// ============================================================================
+// SETTING ENUMS
+// ============================================================================
+
+// Engine settings without a dedicated parameter. They are edited through the
+// Setting/Value parameter pair and saved with the preset.
+enum {
+    kSetRangeStart = 0,  // Edit range first step (1-based loop window position)
+    kSetRangeEnd,        // Edit range last step (0 = loop end)
+    kSetDestTrack,       // Paste/copy destination track (0 = Rec Track, 1-8)
+    kSetDestStep,        // Paste destination step (window position, 0 = range start)
+    kSetEditQuant,       // Now, or deferred to the destination track's loop wrap
+    kSetUserScale1,      // User scale pitch-class masks (bit n = n semitones above root)
+    kSetUserScale2,
+    kSetUserScale3,
+    kSetUserScale4,
+    kSetCountIn,         // Count-in bars before a live recording starts (0 = off)
+    kSetMetronome,       // When clicks sound (METRO_* modes)
+    kSetMetroChannel,    // MIDI click channel (0 = no MIDI click)
+    kSetMetroNote,       // MIDI click note
+    kSetFreezeLoops,     // Loops rendered by Freeze
+    kSetScene,           // Scene slot for Store/Recall (1-based)
+    kSetSceneQuant,      // When a recalled scene takes effect (SCENE_QUANT_*)
+    kSetMute,            // Track mute bitmask (bit n = track n+1)
+    kSetSolo,            // Track solo bitmask (any set = only soloed tracks play)
+    kSetMuteQuant,       // When mute/solo changes take effect (MUTE_QUANT_*)
+    kSetMuteRing,        // Let notes sounding on newly muted tracks finish
+    kSetCcLearn,         // CC_LEARN_*; returns to Off once a CC arrives
+    kSetLaunchCh,        // MIDI channel of pattern launch notes (0 = off)
+    kSetLaunchNote,      // Note launching track 1 slot 1; NUM_PATTERNS notes per track follow
+    kSetLaunchQuant,     // When launched patterns switch in (LAUNCH_QUANT_*)
+    kSetProgLead,        // ms before a launched slot switches in that its program change is sent
+    kSetCvVelocity,      // Velocity of notes recorded from Gate In
+    kSetResume,          // Next start after a preset load continues from its saved position
+
+    kGlobalSettingCount
+};
+
+// Per-track settings (edited for the Rec Track, listed after the global ones)
+enum {
+    kTrkSetFollow = 0,  // Leader track (0 = off, 1-8)
+    kTrkSetFollowOfs,   // Step offset applied to the leader's step
+    kTrkSetLegato,      // Extend sounding notes instead of retriggering; new note-on before old note-off
+    kTrkSetLoopStart,   // First step of the loop window (the window is Length steps long)
+    kTrkSetRepeat,      // Track follows the Beat Repeat parameter
+    kTrkSetDepTrack,    // Track whose result on the same clock gates this one (0 = off, 1-8)
+    kTrkSetDepMode,     // DEP_* condition on that result
+    kTrkSetModType,     // MOD_*: track modulates others instead of playing
+    kTrkSetModDest,     // Modulated tracks bitmask (bit n = track n+1)
+    kTrkSetModAmount,   // Accent velocity boost
+    kTrkSetProgram,     // Program change for the playing pattern slot (0 = none)
+    kTrkSetBank,        // Bank select (CC 0/32) sent before it (0 = none)
+
+    kTrackSettingCount
+};
+
+static constexpr int TOTAL_SETTINGS = kGlobalSettingCount + kTrackSettingCount;
+
 // Helper to get track parameter index
 static inline int trackParam(int track, int param) {
     return kGlobalParamCount + (track * PARAMS_PER_TRACK) + param;
@@ -360,6 +519,122 @@ struct DelayedNote {
     bool active;
 };
 
+// Step range copied by the Copy action (allocated in DRAM after the tracks)
+struct EditClipboard {
+    StepEvents steps[MAX_STEPS];
+    uint8_t length;  // Number of steps held (0 = empty)
+};
+
+// Edit deferred to the destination track's next loop wrap
+struct PendingEdit {
+    uint8_t action;
+    uint8_t srcTrack;
+    uint8_t dstTrack;
+    uint8_t start;     // First source step (1-based)
+    uint8_t end;       // Last source step (1-based)
+    uint8_t destStep;  // First destination step (1-based)
+};
+
+// A track's deferred edits, applied in request order at its next wrap
+struct EditQueue {
+    PendingEdit edits[EDIT_QUEUE_DEPTH];
+    uint8_t count;
+    bool pastePending;  // A queued Paste reads the track's clipboard snapshot
+};
+
+// Input note message kept in the capture history
+struct CaptureEvent {
+    uint32_t tick;      // Global clock count when received
+    uint8_t fraction;   // Position between clocks (0-255)
+    uint8_t note;
+    uint8_t velocity;   // 0 = note off
+    uint8_t pos[MAX_TRACKS];        // Each track's loop window position when received (0 = before its first step)
+    uint8_t divCounter[MAX_TRACKS]; // Clocks already received inside that step
+};
+
+// Always-on input history (allocated in DRAM after the clipboard)
+// Entries are addressed by sequence number; seq maps to events[seq % size]
+struct CaptureBuffer {
+    CaptureEvent events[CAPTURE_BUFFER_SIZE];
+    uint32_t written;   // Total entries ever written
+    uint32_t runStart;  // First sequence number of the current transport run
+};
+
+// Time-sliced commit of captured history into a track
+struct CaptureJob {
+    uint32_t nextSeq;   // Next history entry to commit
+    uint32_t endSeq;    // One past the last entry to commit
+    uint32_t startTick; // First clock inside the capture window
+    uint32_t endTick;   // Clock at which capture was requested
+    uint8_t endPos;     // Track's window position and division counter at that clock
+    uint8_t endDivCounter;
+    uint8_t track;
+    bool active;
+};
+
+// Playback state that drives a track's step pipeline and PRNG draws.
+// Freeze swaps a copy of this in and out of the TrackState to render offline.
+struct PlayCursor {
+    uint32_t randState;
+    uint16_t clockCount;
+    uint16_t loopCount;
+    uint16_t octavePlayCount;
+    uint8_t step;
+    uint8_t walkPos;
+    uint8_t lastStep;
+    uint8_t brownianPos;
+    uint8_t shufflePos;
+    uint8_t shuffleOrder[MAX_STEPS];
+};
+
+// Freeze render target (allocated in DRAM after the capture history)
+struct FreezeBuffer {
+    TrackData data;
+    PlayCursor cursor;   // Render playback state while swapped out
+};
+
+// State copied between audio calls for saving, so a preset never holds a
+// half-updated step (allocated in DRAM after the pattern slots)
+struct SaveStage {
+    TrackData data;                       // One track's playing slot, or the slot being saved/loaded
+    TrackData loadData;                   // A track's playing slot while its preset entry is read
+    PlayCursor cursor[MAX_TRACKS];        // Every track's playback state, copied together
+    uint16_t divCounter[MAX_TRACKS];      // (after a load: the state Resume applies at the next start)
+    uint32_t clockTicks;
+    uint32_t skipMask[MAX_STEPS / 32];    // The staged track's skip mask, settings and slot
+    int16_t settings[kTrackSettingCount];
+    uint8_t pattern;
+};
+
+// Time-sliced render of a track's output into plain events
+struct FreezeJob {
+    uint16_t clock;      // Clocks rendered so far (= next output step index)
+    uint16_t length;     // Output length in steps
+    uint8_t srcTrack;
+    uint8_t dstTrack;
+    bool active;
+};
+
+// Scene snapshot: every per-track parameter and per-track setting
+struct Scene {
+    int16_t params[MAX_TRACKS][PARAMS_PER_TRACK];
+    int16_t settings[MAX_TRACKS][kTrackSettingCount];
+    bool stored;
+};
+
+// Scene recall waiting for its quantize point
+struct SceneRecall {
+    uint8_t scene;
+    bool due;    // Rec Track reached the quantize boundary; apply on the next clock
+    bool active;
+};
+
+// Scene slots and pending recall (allocated in DRAM after the freeze buffer)
+struct SceneBank {
+    Scene scenes[NUM_SCENES];
+    SceneRecall recall;
+};
+
 // Playing note (tracking duration countdown)
 // Indexed by note number in TrackState::playing[128]
 struct PlayingNote {
@@ -383,8 +658,14 @@ struct TrackCache {
 // Unified per-track state (allocated dynamically in DRAM)
 // Combines track data with all per-track runtime state
 struct TrackState {
-    // Step event data
-    TrackData data;
+    // Step event data: the playing pattern slot (points into the pattern bank)
+    TrackData* data;
+    uint8_t pattern;        // Playing slot
+    uint8_t launchSlot;     // Slot waiting to launch (LAUNCH_NONE = none)
+    int16_t slotProgram[NUM_PATTERNS]; // Program/Bank of the slots not playing
+    int16_t slotBank[NUM_PATTERNS];    // (the playing slot's are in settings)
+    int16_t sentProgram;    // Program/Bank last sent on the track's channel
+    int16_t sentBank;       // (sentProgram -1 = send again)
 
     // Playing notes (for duration tracking)
     PlayingNote playing[128];
@@ -393,17 +674,40 @@ struct TrackState {
     // Shuffle order for shuffle direction mode
     uint8_t shuffleOrder[MAX_STEPS];
 
+    // Loop window: walk position -> step table (see refreshStepMap)
+    uint32_t skipMask[MAX_STEPS / 32]; // Skipped steps (bit s = step s+1)
+    uint8_t stepMap[MAX_STEPS];        // Unskipped window steps in play order
+    uint8_t walkLen;                   // Entries in stepMap (0 = every step skipped)
+    uint8_t mapLength;                 // Length and Loop Start stepMap was built for
+    uint8_t mapStart;
+    bool stepMapDirty;                 // Skip mask changed
+
+    // Beat repeat: steps played on recent clocks (indexed by clockCount)
+    uint8_t repeatHist[REPEAT_HISTORY];
+    uint16_t repeatStart;              // clockCount the repeat engaged on
+    uint16_t repeatValid;              // First clockCount repeatHist holds since the last repeat
+    bool repeating;                    // Beat Repeat engaged on this track
+
     // Playback state
     uint16_t clockCount;
     uint16_t divCounter;    // Clock division counter
     uint16_t loopCount;     // Loop iteration counter (for trig conditions)
     uint8_t step;           // Current step position
-    uint8_t lastStep;       // Previous step (for no-repeat)
+    uint8_t walkPos;        // Position in the walk over stepMap (0 = before the first clock)
+    uint8_t lastStep;       // Previous walk position (for stability/no-repeat)
     uint8_t brownianPos;    // Brownian walk position
     uint8_t shufflePos;     // Position in shuffle order
     uint8_t activeVel;      // Highest active velocity (for UI)
     uint16_t octavePlayCount; // Octave jump note-play counter
 
+    // Follow, Dep Track and Mod Type resolved by buildTrackOrder (-1 = none)
+    int8_t leader;
+    int8_t depTrack;
+    bool modulates;         // Mod Type set
+    uint8_t modDest;        // Mod Dest without the tracks whose link formed a cycle
+    bool ticked;            // Processed on the current clock
+    bool wrapped;           // Loop wrapped on the last processed clock
+
     // Parameter change detection
     int16_t lastEnabled;
 
@@ -412,6 +716,70 @@ struct TrackState {
 
     // Per-track PRNG state
     uint32_t randState;
+
+    // Engine settings (see kTrkSet* enum)
+    int16_t settings[kTrackSettingCount];
+
+    // Pitch-class histogram (velocity x duration weighted) for key detection
+    uint32_t pitchHist[12];
+    bool histDirty;           // Rebuild before use (set by bulk edits)
+
+    // Play Density importance ranks (0 = most important), parallel to data.steps
+    uint8_t eventRank[MAX_STEPS][MAX_EVENTS_PER_STEP];
+    bool ranksDirty;          // Rebuilt by updateEventRanks()
+};
+
+// Loop window: step (1-based) at window position `pos` (1-based), and back
+static inline int windowStep(const TrackState* ts, int pos) {
+    return (ts->settings[kTrkSetLoopStart] - 1 + pos - 1) % MAX_STEPS + 1;
+}
+static inline int windowPos(const TrackState* ts, int step) {
+    if (step < 1) return step;
+    return (step - ts->settings[kTrkSetLoopStart] + MAX_STEPS) % MAX_STEPS + 1;
+}
+
+// Skip mask (step is 0-based); changes are picked up on the track's next clock
+static inline bool stepSkipped(const TrackState* ts, int step) {
+    return (ts->skipMask[step >> 5] >> (step & 31)) & 1;
+}
+static inline void setStepSkipped(TrackState* ts, int step, bool skip) {
+    uint32_t bit = 1u << (step & 31);
+    if (skip) {
+        ts->skipMask[step >> 5] |= bit;
+    } else {
+        ts->skipMask[step >> 5] &= ~bit;
+    }
+    ts->stepMapDirty = true;
+}
+
+// Pattern slot storage for a track
+static inline TrackData* patternSlot(TrackData* patterns, int track, int slot) {
+    return &patterns[track * NUM_PATTERNS + slot];
+}
+
+// MIDI CC learn entry: (channel, CC) -> parameter or action
+struct CcMapping {
+    uint8_t channel;    // 0-15
+    uint8_t cc;         // 0-127
+    uint8_t type;       // CC_TARGET_*
+    uint8_t lastValue;  // Previous CC value (action trigger edge)
+    int16_t target;     // Parameter index or ACTION_*
+    int16_t min;        // Parameter range the CC sweeps
+    int16_t max;
+    bool used;
+};
+
+// MIDI CC learn table (allocated in DRAM after the scene bank). midiMessage()
+// only does the slot lookup and stores the latest value; step() applies it.
+struct CcMap {
+    uint8_t slot[16][128];                  // 1-based mapping index per (channel, CC), 0 = unmapped
+    CcMapping mappings[NUM_CC_MAPPINGS];
+    int16_t pendingValue[NUM_CC_MAPPINGS];  // Latest value per mapping since the last step()
+    uint32_t pendingMask;
+    int16_t lastTouched;                    // Parameter learn binds to (-1 = none)
+    uint8_t learnChannel;                   // CC received while learning
+    uint8_t learnCc;
+    bool learnPending;
 };
 
 // DTC (Data Tightly Coupled) - Fast access global state for step()
@@ -430,6 +798,7 @@ struct MidiLooper_DTC {
     // Timing
     float stepTime;
     float stepDuration;
+    uint32_t clockTicks;    // Clocks since transport start
 
     // Edge detection for parameter changes
     int16_t lastRecord;
@@ -437,6 +806,7 @@ struct MidiLooper_DTC {
     int16_t lastClearTrack;
     int16_t lastClearAll;
     int16_t lastGenerate;
+    int16_t lastExecute;
 
     // Step record state
     uint8_t stepRecPos;  // Step record cursor: 1-based division-step index, 0 = inactive
@@ -448,30 +818,118 @@ struct MidiLooper_DTC {
     // Scale quantization note tracking
     // Maps original MIDI note → quantized note sent, so Note Off releases the correct note
     uint8_t noteMap[128];
+
+    // Active scale compiled to a note → note table (see updateScaleLut)
+    uint8_t scaleLut[128];
+
+    // Engine settings (see kSet* enum) and Value parameter sync
+    int16_t settings[kGlobalSettingCount];
+    bool settingSyncPending;  // Push the selected setting's value to the Value parameter
+
+    // Key detection result (shown on the display while keyDisplayTime > 0)
+    uint8_t detectedRoot;
+    uint8_t detectedScale;    // ScaleType, SCALE_OFF if nothing to detect
+    float keyDisplayTime;     // Seconds remaining
+
+    // Tracks whose step played on the current clock (for Dep Track)
+    uint8_t playedMask;
+
+    // Cross-track modulation received by each track on the current clock
+    int16_t modVelocity[MAX_TRACKS];   // Accent boost (reset every clock)
+    uint8_t modChance[MAX_TRACKS];     // Chance % that notes play (reset every clock)
+    int8_t modTranspose[MAX_TRACKS];   // Semitones (held until the next transpose step)
+
+    // Mute/solo (kSetMute/kSetSolo hold the requested masks)
+    uint8_t muteMask;          // Applied masks
+    uint8_t soloMask;
+    uint8_t audibleMask;       // Tracks allowed to emit notes (from mute/solo)
+    bool muteDue;              // Rec Track reached the Mute Quant boundary
+
+    // Pattern launch (see TrackState::launchSlot)
+    uint8_t launchBarMask;     // Tracks whose launch waits for the next bar
+    bool launchBarDue;         // Rec Track reached a bar boundary
+    bool programsPending;      // Send every track's program again on the next step() (preset load)
+    bool resumePending;        // Next transport start keeps the loaded playback state (Resume)
+
+    // Cycle budget (see budget.cpp)
+    uint32_t blockStartCycles;        // NT_getCpuCycleCount() when step() began
+    uint32_t blockBudgetCycles;       // Cycles this block may use before deferring work
+    uint16_t shedRun[kDeferCount];    // Blocks in a row each kind of work was shed
+    uint32_t shedCount[kDeferCount];  // Total sheds (shown on the display)
+    uint8_t generateMask;             // Tracks with a Generate waiting
+
+    // Bumped by every audio-context call that can change state (step, midiMessage);
+    // a save copy taken while it held still is consistent
+    uint32_t writeSeq;
+
+    // CV note input (Pitch In / Gate In)
+    bool cvGateHigh;
+    uint8_t cvNote;            // Note sounding from the gate (CV_NOTE_NONE = none)
+    uint16_t cvSettle;         // Frames until pitch is read for a risen gate (0 = none waiting)
+    float cvEdgeTime;          // stepTime of that gate's rising edge
+
+    // Count-in (REC_COUNT_IN)
+    uint16_t countInRemaining; // Count-in clocks left before the downbeat
+    uint16_t countInElapsed;   // Count-in clocks so far
+
+    // Metronome click output
+    int metroPulseStart;       // Frame offset of the CV click in the current block
+    int metroPulseFrames;      // CV click frames left to write
+    float metroPulseLevel;
+    float metroNoteTime;       // Seconds until the MIDI click note-off (0 = none sounding)
+    uint8_t metroNote;
+    uint8_t metroChannel;
+    uint32_t metroWhere;
 };
 
 // Main algorithm structure (SRAM)
 struct MidiLooperAlgorithm : public _NT_algorithm {
     MidiLooper_DTC* dtc;
     TrackState* trackStates;  // Dynamically allocated per-track state
+    EditClipboard* clipboard; // Copy/paste buffer (DRAM, after trackStates)
+    EditClipboard* pasteClips; // Per-track clipboard snapshot for a queued Paste (after clipboard)
+    CaptureBuffer* capture;   // Input history (DRAM, after pasteClips)
+    FreezeBuffer* freeze;     // Freeze render buffer (DRAM, after capture)
+    SceneBank* scenes;        // Scene slots (DRAM, after freeze buffer)
+    CcMap* ccMap;             // MIDI CC learn table (DRAM, after scenes)
+    uint8_t* pitchMap;        // Note → note table for the Note Map scale, 128 entries (DRAM, after the CC table)
+    TrackData* patterns;      // NUM_PATTERNS slots per track (DRAM, after the Note Map table)
+    SaveStage* stage;         // Save/load staging copy (DRAM, after the pattern slots)
 
     // Dynamic track configuration (from specification)
     uint8_t numTracks;
 
-    // Mutable copy of parameter definitions (for runtime max adjustments)
-    _NT_parameter paramDefs[MAX_TOTAL_PARAMS];
+    // Clock processing order (leaders before their followers)
+    uint8_t trackOrder[MAX_TRACKS];
 
     // Dynamic parameter pages (built in construct based on numTracks)
     uint8_t pageTrackIndices[MAX_TRACKS][PARAMS_PER_TRACK];
     _NT_parameterPage pageDefs[MAX_PAGES];
     _NT_parameterPages dynamicPages;
 
-    // Held notes during recording
-    HeldNote heldNotes[128];
+    // Held notes during recording (SRAM, after this object)
+    HeldNote* heldNotes;
+    uint8_t numHeldNotes;
+
+    // Delayed notes for humanization (SRAM, after this object)
+    DelayedNote* delayedNotes;
+    uint8_t numDelayedNotes;
+
+    // Edits waiting for a loop wrap (Edit Quant = Loop), by destination track
+    EditQueue editQueues[MAX_TRACKS];
+
+    // Capture being committed from the input history
+    CaptureJob captureJob;
 
-    // Delayed notes for humanization
-    DelayedNote delayedNotes[MAX_DELAYED_NOTES];
+    // Freeze being rendered
+    FreezeJob freezeJob;
 
-    MidiLooperAlgorithm(MidiLooper_DTC* dtc_, TrackState* trackStates_, uint8_t numTracks_)
-        : dtc(dtc_), trackStates(trackStates_), numTracks(numTracks_) {}
+    MidiLooperAlgorithm(MidiLooper_DTC* dtc_, TrackState* trackStates_, EditClipboard* clipboard_,
+                        CaptureBuffer* capture_, FreezeBuffer* freeze_, SceneBank* scenes_, CcMap* ccMap_,
+                        uint8_t* pitchMap_, TrackData* patterns_, SaveStage* stage_, uint8_t numTracks_, HeldNote* heldNotes_, uint8_t numHeldNotes_,
+                        DelayedNote* delayedNotes_, uint8_t numDelayedNotes_)
+        : dtc(dtc_), trackStates(trackStates_), clipboard(clipboard_), pasteClips(clipboard_ + 1),
+          capture(capture_), freeze(freeze_),
+          scenes(scenes_), ccMap(ccMap_), pitchMap(pitchMap_), patterns(patterns_), stage(stage_), numTracks(numTracks_), heldNotes(heldNotes_),
+          numHeldNotes(numHeldNotes_), delayedNotes(delayedNotes_), numDelayedNotes(numDelayedNotes_) {}
 };
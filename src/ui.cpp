@@ -1,5 +1,11 @@
 #include "ui.h"
 #include "quantize.h"
+#include "scales.h"
+
+// Short names for the detected key readout
+static const char* const uiRootNames[12] = {"C", "C#", "D", "Eb", "E", "F", "F#", "G", "Ab", "A", "Bb", "B"};
+static const char* const uiScaleNames[SCALE_BUILTIN_COUNT] = {"",     "Ionian", "Dorian", "Phryg",  "Lydian", "Mixo",
+                                                       "Aeol", "Locr",   "HarmMin", "MeloMin", "MajPen", "MinPen"};
 
 // ============================================================================
 // UI HELPER FUNCTIONS
@@ -120,7 +126,11 @@ bool drawUI(MidiLooperAlgorithm* alg) {
         if (transportIsRunning(dtc->transportState)) {
             int loopLen;
             int recQuantize = getCachedQuantize(v, recTrack, &alg->trackStates[recTrack].cache, loopLen);
-            if (recQuantize > 0) {
+            if (recQuantize > 0 && dtc->recordState == REC_COUNT_IN) {
+                // Count-in counts global clocks
+                int clocks = recQuantize * TrackParams::fromAlgorithm(v, recTrack).clockDiv();
+                if (dtc->countInElapsed > 0) activeBeat = ((dtc->countInElapsed - 1) / clocks) % 4;
+            } else if (recQuantize > 0) {
                 activeBeat = ((alg->trackStates[recTrack].clockCount - 1) / recQuantize) % 4;
             }
         }
@@ -135,6 +145,25 @@ bool drawUI(MidiLooperAlgorithm* alg) {
         }
     }
 
+    // Detected key readout (Detect Key / Apply Key)
+    if (dtc->keyDisplayTime > 0.0f && dtc->detectedScale > SCALE_OFF && dtc->detectedScale < SCALE_BUILTIN_COUNT) {
+        NT_drawText(UI_KEY_X, UI_LABEL_Y, uiRootNames[dtc->detectedRoot % 12], UI_BRIGHTNESS_MAX, kNT_textLeft,
+                    kNT_textNormal);
+        NT_drawText(UI_KEY_X + 3 * UI_CHAR_WIDTH, UI_LABEL_Y, uiScaleNames[dtc->detectedScale], UI_BRIGHTNESS_MAX,
+                    kNT_textLeft, kNT_textNormal);
+    }
+
+    // Deferred work shed for lack of budget since construction
+    uint32_t shed = 0;
+    for (int kind = 0; kind < kDeferCount; kind++) {
+        shed += dtc->shedCount[kind];
+    }
+    if (shed > 0) {
+        char buf[16] = "Shed ";
+        NT_intToString(buf + 5, (int)shed);
+        NT_drawText(UI_KEY_X, UI_STEP_Y_BOTTOM, buf, UI_BRIGHTNESS_DIM, kNT_textLeft, kNT_textTiny);
+    }
+
     // Input velocity meter
     NT_drawText(UI_INPUT_LABEL_X, UI_LABEL_Y, "I:", 15, kNT_textLeft, kNT_textNormal);
     drawVelBar(UI_INPUT_BAR_X, dtc->inputVel);